@@ -0,0 +1,58 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_BROADCAST_CODE_H_
+#define LIVOX_DRIVER_CORE_BROADCAST_CODE_H_
+
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#define BD_ARGC_NUM                     (4)
+#define BD_ARGV_POS                     (1)
+#define COMMANDLINE_BD_SIZE             (15)
+
+/* total broadcast code, include broadcast_code_list and commandline input */
+extern std::vector<std::string > total_broadcast_code;
+
+/** add bd to total_broadcast_code */
+void add_broadcast_code(const char* bd_str);
+
+/** add bd in a broadcast_code_list to total_broadcast_code */
+void add_local_broadcast_code(const char** bd_list, int bd_list_size);
+
+/** add commandline bd to total_broadcast_code */
+void add_commandline_broadcast_code(const char* cammandline_str);
+
+/**
+ * add the bd of the private param broadcast_codes to the whitelist and
+ * advertise the reload_broadcast_codes service, which reads the param again
+ */
+void init_param_broadcast_code(ros::NodeHandle &private_node);
+
+/** whether bd_str is in total_broadcast_code or the param, O(1) */
+bool is_broadcast_code_accepted(const char* bd_str);
+
+#endif // LIVOX_DRIVER_CORE_BROADCAST_CODE_H_
@@ -0,0 +1,93 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_CLOCK_SYNC_H_
+#define LIVOX_DRIVER_CORE_CLOCK_SYNC_H_
+
+#include <stdint.h>
+
+#define CLOCK_SYNC_BUCKET_NS            (1000000000ll) // sensor time of one minimum delay bucket
+#define CLOCK_SYNC_BUCKETS              (32)           // buckets of the line fit
+#define CLOCK_SYNC_RESET_NS             (100000000ll)  // delay jump that restarts the estimator
+#define CLOCK_SYNC_RESET_BUCKETS        (3)            // buckets a delay rise must last to restart it
+
+/**
+ * Maps the sensor clock of one lidar to ros time.
+ *
+ * Every packet gives delay = arrival - sensor time, the unknown clock
+ * offset plus a non-negative network and scheduling delay. The minimum
+ * delay of each bucket of sensor time is the sample least disturbed by
+ * that delay, a line fitted through the minima of the last buckets gives
+ * offset and drift. Delays are kept relative to the first one so the fit
+ * works in doubles without losing nanoseconds.
+ *
+ * A sensor clock stepping back or a delay below the line means the sensor
+ * restarted or resynced and restarts the estimator at once. Late packets
+ * are host or network stalls, a bucket whose minimum is far above the line
+ * is left out of the fit and only CLOCK_SYNC_RESET_BUCKETS of them in a
+ * row restart the estimator.
+ */
+typedef struct {
+  bool started;
+  int64_t base_delay;               // delay of the first packet, ns
+  int64_t base_sensor;              // sensor time of the first packet, ns
+
+  /* closed buckets, sensor time and minimum delay relative to the bases */
+  double bucket_sensor[CLOCK_SYNC_BUCKETS];
+  double bucket_delay[CLOCK_SYNC_BUCKETS];
+  uint32_t bucket_count;            // closed buckets so far
+  uint32_t high_buckets;            // consecutive buckets far above the line
+  int64_t last_sensor;              // latest sensor time seen, relative to the base
+
+  /* open bucket */
+  int64_t open_end;                 // sensor time the open bucket closes at
+  int64_t open_min_delay;
+  int64_t open_min_sensor;
+  uint32_t open_samples;
+
+  /* fit, delay = offset + drift * sensor, relative to the bases */
+  bool fitted;
+  double offset;
+  double drift;
+  double fit_rms;                   // ns, minima around the line
+
+  /* residual delay of the packets of the last closed bucket, arrival - mapped time */
+  double residual_sum;
+  double residual_max;
+  uint32_t residual_count;
+  double last_residual_mean;        // ns
+  double last_residual_max;         // ns
+  uint32_t last_samples;
+  uint32_t resets;
+} ClockSync;
+
+void ClockSyncReset(ClockSync *sync);
+
+/** Add one packet, return true when a bucket closed and the fit was updated. */
+bool ClockSyncAdd(ClockSync *sync, uint64_t sensor_ns, uint64_t arrival_ns);
+
+/** Ros time in ns of sensor_ns, false before the first packet. */
+bool ClockSyncMap(const ClockSync *sync, uint64_t sensor_ns, uint64_t *ros_ns);
+
+#endif // LIVOX_DRIVER_CORE_CLOCK_SYNC_H_
@@ -0,0 +1,54 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_COMPACT_CLOUD_H_
+#define LIVOX_DRIVER_CORE_COMPACT_CLOUD_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "livox_sdk.h"
+#include <sensor_msgs/PointCloud2.h>
+
+/**
+ * Fixed-point PointCloud2 layouts built straight from LivoxRawPoint.
+ * x/y/z are integers in units of CompactFormatScale() meters, intensity
+ * is the raw uint8 reflectivity, points are packed without padding.
+ */
+typedef enum {
+  kCompactFormatNone = 0,
+  kCompactFormatInt32Mm = 1,   // 13 bytes per point
+  kCompactFormatInt16Cm = 2,   // 7 bytes per point, +-327.67m
+} CompactFormat;
+
+CompactFormat CompactFormatFromString(const std::string &name);
+const char* CompactFormatName(CompactFormat format);
+double CompactFormatScale(CompactFormat format);
+
+/** Fill fields and data of msg, return the number of points out of range of the format. */
+uint32_t CompactCloudFill(sensor_msgs::PointCloud2 *msg, CompactFormat format,
+                          const LivoxRawPoint *points, uint32_t num);
+
+#endif // LIVOX_DRIVER_CORE_COMPACT_CLOUD_H_
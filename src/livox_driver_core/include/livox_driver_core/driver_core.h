@@ -0,0 +1,475 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_DRIVER_CORE_H_
+#define LIVOX_DRIVER_CORE_DRIVER_CORE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+
+#include "livox_sdk.h"
+#include <ros/ros.h>
+
+#include "livox_driver_core/outputs.h"
+#include "livox_driver_core/output_stream.h"
+#include "livox_driver_core/point_layout.h"
+#include "livox_driver_core/packet_time.h"
+
+#define POINTS_PER_FRAME                5000      // must < buffer points of the queue
+#define PACKET_GAP_WARMUP               (64)      // packets to learn the interval before flagging gaps
+#define PACKET_GAP_EWMA_SHIFT           (6)       // ewma weight 1/64
+#define PACKET_GAP_SIGMA                (6.0)     // gap flagged beyond mean + 6 sigma
+#define PACKET_GAP_MIN_RATIO            (1.5)     // and beyond 1.5 times the mean
+#define PACKET_GAP_RELEARN              (16)      // gaps in a row beyond it that relearn the interval
+#define PACKET_GAP_MISSING_MAX          (65536)   // missing packets counted for one gap at most
+
+#define HUB_SLOT_NUM                    (16)      // slot and id of hub packets, must be 2^n
+#define HUB_ID_NUM                      (16)
+
+#define PACKET_STAMP_NUM                (2048)    // must be 2^n, packets covering the largest queue
+
+/* times of one packet in the queue */
+typedef struct {
+  uint32_t point_idx;             // wr_idx of the first point of the packet
+  uint64_t sensor_ns;             // timestamp of the packet, 0 if not decoded
+  uint64_t arrival_ns;            // ros time the packet arrived
+} PacketStamp;
+
+/**
+ * Ring of raw points of one lidar. GetLidarData() of the SDK thread is the
+ * only writer, PollPointcloudData() of the ros thread the only reader.
+ * The packet stamps run next to the points to stamp the frames.
+ */
+struct PointCloudQueue {
+  LivoxRawPoint *buffer;
+  volatile uint32_t rd_idx;
+  volatile uint32_t wr_idx;
+  uint32_t mask;
+  uint32_t size;  // must be 2^n
+
+  PacketStamp stamps[PACKET_STAMP_NUM];
+  volatile uint32_t stamp_wr;
+  uint32_t stamp_rd;              // stamp covering rd_idx
+  uint32_t stamp_fed;             // next stamp for the clock estimator
+
+  volatile uint32_t dropped_points;   // points of packets that found the ring full
+};
+
+/**
+ * Packet statistic of one lidar. The nominal interval between packets is
+ * learned online (ewma of mean and variance), a gap well beyond it counts
+ * the packets that fit into it as lost. PACKET_GAP_RELEARN such gaps in a
+ * row mean the interval changed, it is learned again.
+ */
+typedef struct {
+  uint32_t receive_packet_count;
+  uint32_t loss_packet_count;     // estimated missing packets
+  uint64_t last_timestamp;        // ns, see packet_time.h
+  uint8_t last_timestamp_type;
+  uint32_t interval_samples;
+  uint32_t interval_gaps;         // gaps in a row flagged as loss
+  double interval_mean;           // ns
+  double interval_var;            // ns^2
+} LidarPacketStatistic;
+
+/* reconnect progress of a device, see reconnect.h */
+typedef enum {
+  kReconnectNone = 0,
+  kReconnectDisconnected = 1,     // disconnect seen, waiting for the connect event
+  kReconnectConnected = 2,        // connected again, waiting for the first point
+  kReconnectFirstPoint = 3,       // first point arrived, report pending
+} ReconnectStage;
+
+typedef struct {
+  volatile uint32_t stage;        // ReconnectStage
+  volatile uint32_t flush_pending;
+  uint64_t disconnect_ns;
+  uint64_t connect_ns;
+  uint64_t first_point_ns;
+  uint64_t next_attempt_ns;       // earliest next start sampling command
+  uint32_t attempts;
+  uint32_t flushed_points;
+} DeviceReconnect;
+
+/* for device connect use ----------------------------------------------------------------------- */
+typedef enum {
+  kDeviceStateDisconnect = 0,
+  kDeviceStateConnect = 1,
+  kDeviceStateSampling = 2,
+} DeviceState;
+
+typedef struct {
+  uint8_t handle;
+  DeviceState device_state;
+  DeviceInfo info;
+  LidarPacketStatistic statistic_info;   // written by the sdk thread only
+  volatile uint32_t statistic_reset;      // set by the ros thread, the sdk thread clears statistic_info
+  DeviceReconnect reconnect;
+} DeviceItem;
+
+extern PointCloudQueue point_cloud_queue_pool[kMaxLidarCount];
+extern DeviceItem lidars[kMaxLidarCount];
+
+/* for global publisher use */
+extern ros::Publisher cloud_pub;
+extern ros::Publisher meta_pub;
+
+/* for device timing use, not affected by clock jumps */
+static inline uint64_t MonotonicNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* for pointcloud queue process */
+bool PointCloudPoolInit(uint32_t buffer_points, bool allocate = true);
+void PointCloudPoolUninit(void);
+
+/*
+ * Queues of a pool inited without allocate come and go with the lidars.
+ * Only the ros thread allocates and retires them. A retired buffer is
+ * deleted by PointCloudQueueReclaim() once the sdk thread surely left it.
+ * The write indices stay with the sdk thread throughout, a new buffer
+ * starts reading at them.
+ */
+bool PointCloudQueueAlloc(uint8_t handle);
+void PointCloudQueueRetire(uint8_t handle);
+void PointCloudQueueReclaim(void);
+
+/**
+ * A new lidar took over handle or its queue was allocated, from the ros
+ * thread: drop the queued points and packet stamps and restart the clock
+ * estimate. Only the read side is touched, the sdk thread keeps writing.
+ */
+void PointCloudQueueFlush(uint8_t handle);
+
+static inline void QueuePop(PointCloudQueue *queue, LivoxRawPoint *out_point) {
+  *out_point = queue->buffer[queue->rd_idx & queue->mask];
+  queue->rd_idx++;
+}
+
+static inline void QueuePush(PointCloudQueue *queue, const LivoxRawPoint *in_point) {
+  queue->buffer[queue->wr_idx & queue->mask] = *in_point;
+  queue->wr_idx++;
+}
+
+/** Pop num points at once, in at most two copies around the end of the ring. */
+static inline void QueuePopBatch(PointCloudQueue *queue, LivoxRawPoint *out_points, uint32_t num) {
+  uint32_t rd = queue->rd_idx & queue->mask;
+  uint32_t first = queue->size - rd;
+  if (first > num) {
+    first = num;
+  }
+  memcpy(out_points, &queue->buffer[rd], first * sizeof(LivoxRawPoint));
+  memcpy(out_points + first, queue->buffer, (num - first) * sizeof(LivoxRawPoint));
+  queue->rd_idx += num;
+}
+
+/** Drop num points without reading them. */
+static inline void QueueSkip(PointCloudQueue *queue, uint32_t num) {
+  queue->rd_idx += num;
+}
+
+/** Push up to num points into buffer of queue, returns the points pushed. */
+static inline uint32_t QueuePushBatch(PointCloudQueue *queue, LivoxRawPoint *buffer,
+                                      const LivoxRawPoint *in_points, uint32_t num) {
+  uint32_t free_size = queue->mask - (queue->wr_idx - queue->rd_idx);
+  if (num > free_size) {
+    num = free_size;
+  }
+
+  uint32_t wr = queue->wr_idx & queue->mask;
+  uint32_t first = queue->size - wr;
+  if (first > num) {
+    first = num;
+  }
+  memcpy(&buffer[wr], in_points, first * sizeof(LivoxRawPoint));
+  memcpy(buffer, in_points + first, (num - first) * sizeof(LivoxRawPoint));
+  queue->wr_idx += num;
+  return num;
+}
+
+static inline uint32_t QueueUsedSize(PointCloudQueue *queue) {
+  return queue->wr_idx - queue->rd_idx;
+}
+
+static inline uint32_t QueueIsFull(PointCloudQueue *queue) {
+  return (QueueUsedSize(queue) >= queue->mask);
+}
+
+static inline uint32_t QueueIsEmpty(PointCloudQueue *queue) {
+  return (queue->rd_idx == queue->wr_idx);
+}
+
+/* for handle mapping of GetLidarData, resolved at compile time --------------------------------- */
+
+/** Data callback handle is the lidar handle, lidars connected directly. */
+struct LidarHandleMap {
+  static inline uint8_t LidarHandle(uint8_t handle, const LivoxEthPacket *packet) {
+    return handle;
+  }
+};
+
+/*
+ * Lidar handle + 1 of each slot and id behind the hub, 0 when no lidar is
+ * known there. Filled from the connected devices on device change,
+ * so a hub packet is mapped by a single load.
+ */
+extern uint8_t hub_handle_table[HUB_SLOT_NUM * HUB_ID_NUM];
+
+/** Rebuild hub_handle_table from the connected devices. */
+void HubHandleTableUpdate(const DeviceInfo *devices, uint8_t count);
+
+/** Slot and id not in the table: ask the sdk, cache a valid handle and count the rest. */
+uint8_t HubHandleTableMiss(uint8_t slot, uint8_t id);
+
+/** Data callback handle is the hub, the lidar comes from slot and id of the packet. */
+struct HubHandleMap {
+  static inline uint8_t LidarHandle(uint8_t hub_handle, const LivoxEthPacket *packet) {
+    uint8_t slot = packet->slot;
+    uint8_t id = packet->id;
+    if ((slot < HUB_SLOT_NUM) && (id < HUB_ID_NUM)) {
+      uint8_t entry = hub_handle_table[slot * HUB_ID_NUM + id];
+      if (entry) {
+        return entry - 1;
+      }
+    }
+    return HubHandleTableMiss(slot, id);
+  }
+};
+
+/** Track the first packet of device handle after a reconnect, see reconnect.h. */
+void ReconnectOnPacket(uint8_t handle);
+
+/** Stamp the first packet of lidar handle, see startup.h. */
+void StartupOnPacket(uint8_t handle);
+
+/** Statistic and queue the points of one packet of lidar handle. */
+void ProcessLidarData(uint8_t handle, LivoxEthPacket *data, uint32_t data_num);
+
+/** Data callback registered with SetDataCallback(). */
+template <typename HandleMap>
+void GetLidarData(uint8_t handle, LivoxEthPacket *data, uint32_t data_num) {
+  if (!data || !data_num) {
+    return;
+  }
+
+  if (handle >= kMaxLidarCount) {
+    return;
+  }
+
+  ReconnectOnPacket(handle);
+
+  /* caculate which lidar this eth packet data belong to */
+  uint8_t lidar_handle = HandleMap::LidarHandle(handle, data);
+  if (lidar_handle >= kMaxLidarCount) {
+    return;
+  }
+
+  /* the lidar, not the hub it came through, sent the packet */
+  StartupOnPacket(lidar_handle);
+
+  ProcessLidarData(lidar_handle, data, data_num);
+}
+
+/* for pointcloud convert process --------------------------------------------------------------- */
+/* sensor clock span and arrival of one frame, for its metadata */
+typedef struct {
+  uint64_t first_sensor_ns;       // 0 if the packet carried no usable time
+  uint64_t last_sensor_ns;
+  uint64_t first_arrival_ns;      // 0 if unknown
+} FrameTiming;
+
+/**
+ * Ros time of the first point of the next num points of queue, from the
+ * sensor clock of the packet it came in, or its arrival if the clock is not
+ * usable. The packets of the frame feed the clock estimator of handle.
+ */
+ros::Time QueueFrameStamp(uint8_t handle, PointCloudQueue *queue, uint32_t num, FrameTiming *timing);
+
+/**
+ * Ros time of the point at point_idx of queue, for readers with their own
+ * cursor. stamp_rd is the packet stamp cursor of the reader, the clock
+ * estimator is fed by QueueFrameStamp only.
+ */
+ros::Time QueuePointStamp(uint8_t handle, PointCloudQueue *queue, uint32_t point_idx, uint32_t *stamp_rd);
+
+/**
+ * Sensor times of the next num points of queue relative to the first, one
+ * entry per packet, after QueueFrameStamp. A single evenly spaced packet if
+ * the packets carry no sensor time. Valid until the next call.
+ */
+const FrameTimes *QueueFrameTimes(PointCloudQueue *queue, uint32_t num);
+
+/**
+ * Packet of the point at point_idx of queue, NULL if none arrived yet, for
+ * readers with their own packet stamp cursor stamp_rd.
+ */
+const PacketStamp *QueuePointPacket(PointCloudQueue *queue, uint32_t point_idx, uint32_t *stamp_rd);
+
+/* header seq of the cloud topic, consecutive over all handles so subscribers see drops as gaps */
+extern uint32_t cloud_seq;
+
+/**
+ * Publish the metadata of the frame just published on cloud topic, num
+ * points popped from the queue of handle and published of them.
+ */
+void PublishFrameMeta(uint8_t handle, const std_msgs::Header &header, const FrameTiming &timing,
+                      uint32_t num, uint32_t published);
+
+/**
+ * Intensity calibration table of the lidar at handle, loaded from
+ * <intensity_lut_dir>/<broadcast code>.lut when its broadcast code changes.
+ * NULL keeps the raw reflectivity.
+ */
+const IntensityLut *IntensityLutOfHandle(uint8_t handle);
+
+extern bool outlier_filter_enable;
+
+/**
+ * Remove the outliers of one converted frame of handle, raw and converted
+ * points are compacted alike, points is NULL for a frame that was not
+ * converted. Returns the points left.
+ */
+uint32_t FrameOutlierFilter(uint8_t handle, LivoxRawPoint *raw_points, void *points, uint32_t point_step,
+                            uint32_t num);
+
+template <typename Layout>
+void PublishPointcloudData(uint8_t handle, PointCloudQueue *queue, uint32_t num) {
+  static LivoxRawPoint raw_points[POINTS_PER_FRAME];
+  typedef LayoutCloud<typename Layout::Point> Cloud;
+
+  /* nobody takes the cloud, the frame still feeds the clock estimator, the metadata and the raw outputs */
+  FrameTiming timing;
+  OutputsNeed need = OutputsFrameNeed();
+  if ((need != kOutputsNeedCloud) && !cloud_pub.getNumSubscribers()) {
+    std_msgs::Header header;
+    header.seq = ++cloud_seq;
+    header.frame_id = "livox_frame";
+    header.stamp = QueueFrameStamp(handle, queue, num, &timing);
+    if ((need == kOutputsNeedNone) && !meta_pub.getNumSubscribers()) {
+      QueueSkip(queue, num);
+      PublishFrameMeta(handle, header, timing, num, num);
+      return;
+    }
+
+    QueuePopBatch(queue, raw_points, num);
+    uint32_t kept = num;
+    if (outlier_filter_enable) {
+      kept = FrameOutlierFilter(handle, raw_points, NULL, 0, num);
+    }
+    PublishFrameMeta(handle, header, timing, num, kept);
+    if (need == kOutputsNeedRaw) {
+      OutputsPublishRawFrame(handle, raw_points, kept, header.stamp);
+    }
+    return;
+  }
+
+  /* init point cloud data struct */
+  boost::shared_ptr<Cloud> cloud(new Cloud);
+  cloud->header.seq = ++cloud_seq;
+  cloud->header.frame_id = "livox_frame";
+  cloud->header.stamp = QueueFrameStamp(handle, queue, num, &timing);
+  cloud->points.resize(num);
+
+  const FrameTimes *times = Layout::kPointTimes ? QueueFrameTimes(queue, num) : NULL;
+  QueuePopBatch(queue, raw_points, num);
+  const IntensityLut *lut = Layout::kIntensity ? IntensityLutOfHandle(handle) : NULL;
+  Layout::Convert(&cloud->points[0], raw_points, num, handle, lut, times);
+  uint32_t published = num;
+  if (outlier_filter_enable) {
+    published = FrameOutlierFilter(handle, raw_points, &cloud->points[0], sizeof(typename Layout::Point), num);
+    cloud->points.resize(published);
+  }
+
+  cloud_pub.publish(cloud);
+  PublishFrameMeta(handle, cloud->header, timing, num, published);
+  num = published;
+
+  OutputsPublishFrame<typename Layout::Point>(handle, raw_points, num, cloud);
+}
+
+template <typename Layout>
+void PublishOutputStreamFrame(OutputStream *stream, uint8_t handle) {
+  typedef LayoutCloud<typename Layout::Point> Cloud;
+  OutputStreamFrame *frame = &stream->frames[handle];
+
+  boost::shared_ptr<Cloud> cloud(new Cloud);
+  cloud->header.seq = ++stream->seq;
+  cloud->header.frame_id = "livox_frame";
+  cloud->header.stamp = frame->stamp;
+  cloud->points.resize(frame->points.size());
+  if (!frame->points.empty()) {
+    const FrameTimes *times = Layout::kPointTimes ? OutputStreamFrameTimes(frame) : NULL;
+    const IntensityLut *lut = Layout::kIntensity ? IntensityLutOfHandle(handle) : NULL;
+    Layout::Convert(&cloud->points[0], &frame->points[0], frame->points.size(), handle, lut, times);
+  }
+  stream->pub.publish(cloud);
+
+  OutputStreamFrameReset(stream, frame);
+}
+
+template <typename Layout>
+void PollLayoutPointcloudData(void) {
+  for (int i = 0; i < kMaxLidarCount; i++) {
+    PointCloudQueue *p_queue  = &point_cloud_queue_pool[i];
+    if (!p_queue->buffer) {
+      continue;
+    }
+
+    /* the streams read up to wr_idx before the main frame frees any of it */
+    uint32_t wr_idx = p_queue->wr_idx;
+    for (uint32_t s = 0; s < output_stream_count; s++) {
+      while (OutputStreamAssemble(&output_streams[s], i, p_queue, wr_idx)) {
+        PublishOutputStreamFrame<Layout>(&output_streams[s], i);
+      }
+    }
+
+    if (wr_idx - p_queue->rd_idx > POINTS_PER_FRAME) {
+      //ROS_DEBUG("%d %d %d %d\r\n", i, p_queue->rd_idx, p_queue->wr_idx, QueueUsedSize(p_queue));
+      PublishPointcloudData<Layout>(i, p_queue, POINTS_PER_FRAME);
+    }
+  }
+
+  OutputsPoll();
+}
+
+/**
+ * Advertise topic and init the outputs in the point layout of the private
+ * parameter point_layout: xyz, xyzi (default), xyzit, xyzr or xyzil.
+ */
+bool PointCloudPublishInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic);
+
+/** Poll reconnects, startup and hub topology, then publish the full frames of all queues in the layout chosen at init. */
+void PollPointcloudData(void);
+
+/* for device control use ----------------------------------------------------------------------- */
+
+/** Query the firmware version of Livox LiDAR. */
+void OnDeviceInformation(uint8_t status, uint8_t handle, DeviceInformationResponse *ack, void *data);
+
+#endif // LIVOX_DRIVER_CORE_DRIVER_CORE_H_
@@ -0,0 +1,183 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_FRAME_WINDOW_H_
+#define LIVOX_DRIVER_CORE_FRAME_WINDOW_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include "livox_driver_core/point_fields.h"
+#include "livox_driver_core/point_layout.h"
+
+#define WINDOW_SEGMENTS_MIN             (256)     // must be 2^n
+#define WINDOW_SEGMENTS_MAX             (65536)   // must be 2^n
+
+/* one published frame, kept alive by reference while it is inside the window */
+typedef struct {
+  ros::Time stamp;
+  boost::shared_ptr<const void> owner;
+  const uint8_t *data;
+  uint32_t point_count;
+} FrameSegment;
+
+/* time-indexed ring of recently published frames, all of the same point layout */
+typedef struct {
+  std::vector<FrameSegment> segments;
+  uint32_t rd_idx;
+  uint32_t wr_idx;
+  uint32_t mask;
+  uint32_t point_count;
+  uint32_t point_step;
+  const std::vector<sensor_msgs::PointField> *fields;
+  ros::Duration span;
+} FrameWindow;
+
+/**
+ * Sliding-window cloud that only references the segments of a FrameWindow.
+ * It goes on the wire as a sensor_msgs/PointCloud2, the points of every
+ * segment are written straight into the outgoing buffer. A deduplicated
+ * cloud only writes the points listed in kept.
+ */
+struct AccumulatedCloud {
+  std_msgs::Header header;
+  std::vector<FrameSegment> segments;
+  const std::vector<sensor_msgs::PointField> *fields;
+  uint32_t point_step;
+  uint32_t width;
+  bool deduplicated;
+  std::vector<uint32_t> kept;     // ascending indices over the points of all segments
+};
+
+typedef boost::shared_ptr<AccumulatedCloud> AccumulatedCloudPtr;
+
+/**
+ * Window of span_sec holding up to max_segments frames, rounded up to 2^n.
+ * A frame pushed into a full window drops the oldest one before its time.
+ */
+void FrameWindowInit(FrameWindow *window, double span_sec, uint32_t max_segments, uint32_t point_step,
+                     const std::vector<sensor_msgs::PointField> *fields);
+void FrameWindowPush(FrameWindow *window, const FrameSegment &segment);
+void FrameWindowAgeOut(FrameWindow *window, const ros::Time &now);
+AccumulatedCloudPtr FrameWindowSnapshot(const FrameWindow *window);
+
+template <typename PointT>
+inline void FrameWindowInit(FrameWindow *window, double span_sec, uint32_t max_segments) {
+  FrameWindowInit(window, span_sec, max_segments, sizeof(PointT), &PointFields<PointT>());
+}
+
+template <typename PointT>
+inline FrameSegment MakeFrameSegment(const boost::shared_ptr<const LayoutCloud<PointT> > &cloud) {
+  FrameSegment segment;
+  segment.stamp = cloud->header.stamp;
+  segment.owner = cloud;
+  segment.data = cloud->points.empty() ? NULL : (const uint8_t *)&cloud->points[0];
+  segment.point_count = cloud->points.size();
+  return segment;
+}
+
+namespace ros {
+namespace message_traits {
+
+template<> struct MD5Sum<AccumulatedCloud> {
+  static const char* value() { return MD5Sum<sensor_msgs::PointCloud2>::value(); }
+  static const char* value(const AccumulatedCloud&) { return value(); }
+};
+
+template<> struct DataType<AccumulatedCloud> {
+  static const char* value() { return DataType<sensor_msgs::PointCloud2>::value(); }
+  static const char* value(const AccumulatedCloud&) { return value(); }
+};
+
+template<> struct Definition<AccumulatedCloud> {
+  static const char* value() { return Definition<sensor_msgs::PointCloud2>::value(); }
+  static const char* value(const AccumulatedCloud&) { return value(); }
+};
+
+} // namespace message_traits
+
+namespace serialization {
+
+template<> struct Serializer<AccumulatedCloud> {
+  template<typename Stream>
+  inline static void write(Stream& stream, const AccumulatedCloud& m) {
+    stream.next(m.header);
+    stream.next((uint32_t)1);
+    stream.next(m.width);
+    stream.next(*m.fields);
+    stream.next((uint8_t)0);
+    stream.next(m.point_step);
+    stream.next((uint32_t)(m.point_step * m.width));
+
+    stream.next((uint32_t)(m.point_step * m.width));
+    if (!m.deduplicated) {
+      for (size_t i = 0; i < m.segments.size(); ++i) {
+        uint32_t data_size = m.point_step * m.segments[i].point_count;
+        memcpy(stream.advance(data_size), m.segments[i].data, data_size);
+      }
+    } else {
+      size_t segment = 0;
+      uint32_t segment_start = 0;
+      for (size_t i = 0; i < m.kept.size(); ++i) {
+        while (m.kept[i] >= segment_start + m.segments[segment].point_count) {
+          segment_start += m.segments[segment].point_count;
+          segment++;
+        }
+        memcpy(stream.advance(m.point_step),
+               m.segments[segment].data + (m.kept[i] - segment_start) * m.point_step, m.point_step);
+      }
+    }
+
+    stream.next((uint8_t)1);
+  }
+
+  template<typename Stream>
+  inline static void read(Stream& stream, AccumulatedCloud& m) {
+    /* publish only, subscribers receive a plain sensor_msgs/PointCloud2 */
+  }
+
+  inline static uint32_t serializedLength(const AccumulatedCloud& m) {
+    uint32_t length = 0;
+
+    length += serializationLength(m.header);
+    length += 4 + 4;                        // height, width
+    length += serializationLength(*m.fields);
+    length += 1 + 4 + 4;                    // is_bigendian, point_step, row_step
+    length += 4 + m.point_step * m.width;
+    length += 1;                            // is_dense
+
+    return length;
+  }
+};
+
+} // namespace serialization
+} // namespace ros
+
+#endif // LIVOX_DRIVER_CORE_FRAME_WINDOW_H_
@@ -0,0 +1,68 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_GROUND_SEGMENT_H_
+#define LIVOX_DRIVER_CORE_GROUND_SEGMENT_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "livox_sdk.h"
+
+/* lengths in meters, in the frame of the published points, z up */
+typedef struct {
+  float cell_size;
+  float range;                    // grid covers |x|, |y| < range
+  float sensor_height;            // expected ground at z = -sensor_height
+  float height_tolerance;         // lowest point of a ground cell within this of the prior
+  float thickness;                // ground points within this above the lowest point
+} GroundSegmentConfig;
+
+/**
+ * Grid ground segmentation of one frame. Every x/y cell takes the lowest
+ * point binned into it, a cell whose lowest point lies near the expected
+ * ground height is ground, together with its points close above it. Cells
+ * are stamped with the frame they were written in, so nothing is cleared
+ * between frames.
+ */
+typedef struct {
+  GroundSegmentConfig config;
+  uint32_t cols;
+  std::vector<float> min_z;
+  std::vector<uint32_t> cell_frame;
+  uint32_t frame;
+
+  /* per point scratch of GroundSegmentClassify() */
+  std::vector<int32_t> cell;
+  std::vector<float> z;
+} GroundSegment;
+
+void GroundSegmentInit(GroundSegment *segment, const GroundSegmentConfig &config);
+
+/** Set is_ground[i] to 1 for ground points, 0 otherwise, returns the ground point count. */
+uint32_t GroundSegmentClassify(GroundSegment *segment, const LivoxRawPoint *points, uint32_t num,
+                               uint8_t *is_ground);
+
+#endif // LIVOX_DRIVER_CORE_GROUND_SEGMENT_H_
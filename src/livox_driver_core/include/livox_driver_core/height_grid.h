@@ -0,0 +1,84 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_HEIGHT_GRID_H_
+#define LIVOX_DRIVER_CORE_HEIGHT_GRID_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "livox_sdk.h"
+#include <nav_msgs/OccupancyGrid.h>
+#include <sensor_msgs/Image.h>
+
+/* one cell, unknown while hits is 0 or its last hit is older than the decay */
+typedef struct {
+  float min_z;                    // m
+  float max_z;                    // m
+  uint32_t last_ms;               // time of the last hit
+  uint16_t hits;
+} HeightGridCell;
+
+/**
+ * Rolling 2D height grid of size x size cells in a fixed frame. Cell
+ * (ix, iy) of the frame is stored at (ix mod size, iy mod size), so moving
+ * the window with the vehicle only clears the rows and columns it leaves
+ * behind. Cells forget their hits after decay_ms without a new one, moving
+ * objects do not leave trails.
+ */
+typedef struct {
+  float resolution;               // m per cell
+  uint32_t size;                  // cells per side
+  float obstacle_height;          // m, max_z - min_z of an occupied cell
+  uint32_t decay_ms;
+  int32_t origin_x;               // cell index of the lower left corner of the window
+  int32_t origin_y;
+  std::vector<HeightGridCell> cells;
+} HeightGrid;
+
+/* points to the grid frame, p' = rotation * p + translation, meters */
+typedef struct {
+  float rotation[3][3];
+  float translation[3];
+} HeightGridTransform;
+
+void HeightGridInit(HeightGrid *grid, float resolution, uint32_t size, float obstacle_height, uint32_t decay_ms);
+
+/** Scroll the window so that x/y of the grid frame is at its center. */
+void HeightGridRecenter(HeightGrid *grid, float x, float y);
+
+void HeightGridInsert(HeightGrid *grid, const LivoxRawPoint *points, uint32_t num,
+                      const HeightGridTransform &transform, uint32_t now_ms);
+
+/** Fill info and data of occupancy: -1 unknown, 0 free, 100 occupied. */
+void HeightGridFillOccupancy(const HeightGrid *grid, uint32_t now_ms, nav_msgs::OccupancyGrid *occupancy);
+
+/**
+ * Fill size, encoding and data of elevation: 32FC2 min_z/max_z in meters,
+ * NaN unknown, pixels laid out like the cells of the occupancy grid.
+ */
+void HeightGridFillElevation(const HeightGrid *grid, uint32_t now_ms, sensor_msgs::Image *elevation);
+
+#endif // LIVOX_DRIVER_CORE_HEIGHT_GRID_H_
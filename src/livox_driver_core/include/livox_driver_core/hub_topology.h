@@ -0,0 +1,56 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_HUB_TOPOLOGY_H_
+#define LIVOX_DRIVER_CORE_HUB_TOPOLOGY_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "livox_sdk.h"
+#include <ros/ros.h>
+
+/**
+ * Lidars behind the hub, by handle.
+ *
+ * The sdk thread hands over the connected devices on every device change,
+ * the ros thread diffs them against the lidars it knows:
+ *   added    queue allocated, lidars[handle] filled
+ *   removed  queue retired, per handle outputs released, lidars[handle] cleared
+ *   changed  another lidar, slot or id at the handle, queue, packet stamps,
+ *            clock estimate, statistics and per handle outputs reset so
+ *            its points never mix with the old ones
+ * and publishes the lidars latched on <topic>_topology.
+ */
+
+void HubTopologyInit(ros::NodeHandle &node, const std::string &topic);
+
+/** Query the connected devices, update the hub handle table and hand them to the ros thread. */
+void HubTopologyRefresh(void);
+
+/** Apply the last connected devices, from the ros thread. */
+void HubTopologyPoll(void);
+
+#endif // LIVOX_DRIVER_CORE_HUB_TOPOLOGY_H_
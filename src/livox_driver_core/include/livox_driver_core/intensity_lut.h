@@ -0,0 +1,89 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_INTENSITY_LUT_H_
+#define LIVOX_DRIVER_CORE_INTENSITY_LUT_H_
+
+#include <stdint.h>
+#include <math.h>
+
+#include "livox_sdk.h"
+
+#define INTENSITY_LUT_RANGE_BINS        (8)       // most range bins of one table
+#define INTENSITY_LUT_SIZE              (256)     // one entry per raw reflectivity
+
+/**
+ * Calibrated intensity of each raw reflectivity of one lidar. Range bins
+ * are range_step wide, the table of a bin holds at its center and points in
+ * between interpolate the two nearest bins. A table of one bin does not
+ * depend on range.
+ *
+ * File format, text, # starts a comment:
+ *
+ *   range_step <m>
+ *   range_bins <n>
+ *   <256 values of bin 0>
+ *   ...
+ *   <256 values of bin n - 1>
+ */
+typedef struct {
+  uint32_t range_bins;
+  float range_step;               // m
+  float table[INTENSITY_LUT_RANGE_BINS][INTENSITY_LUT_SIZE];
+} IntensityLut;
+
+/** Returns 0 on success. */
+int IntensityLutLoad(IntensityLut *lut, const char *path);
+int IntensityLutSave(const IntensityLut *lut, const char *path);
+
+/* write the calibrated intensity of num raw points to intensity, stride bytes apart */
+static inline void IntensityLutApply(const IntensityLut *lut, float *intensity, uint32_t stride,
+                                     const LivoxRawPoint *raw, uint32_t num) {
+  uint8_t *out = (uint8_t *)intensity;
+
+  if (lut->range_bins == 1) {
+    const float *table = lut->table[0];
+    for (uint32_t i = 0; i < num; i++) {
+      *(float *)(out + i * stride) = table[raw[i].reflectivity];
+    }
+    return;
+  }
+
+  float inv_step = 1.0f / (lut->range_step * 1000.0f);      // raw points are in mm
+  float last = (float)(lut->range_bins - 1);
+  for (uint32_t i = 0; i < num; i++) {
+    float x = (float)raw[i].x;
+    float y = (float)raw[i].y;
+    float z = (float)raw[i].z;
+    float pos = sqrtf(x * x + y * y + z * z) * inv_step - 0.5f;
+    pos = (pos < 0.0f) ? 0.0f : ((pos > last) ? last : pos);
+    uint32_t bin = (uint32_t)pos;
+    bin = (bin == lut->range_bins - 1) ? bin - 1 : bin;
+    float lower = lut->table[bin][raw[i].reflectivity];
+    float upper = lut->table[bin + 1][raw[i].reflectivity];
+    *(float *)(out + i * stride) = lower + (pos - bin) * (upper - lower);
+  }
+}
+
+#endif // LIVOX_DRIVER_CORE_INTENSITY_LUT_H_
@@ -0,0 +1,63 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_LIVOX_CODEC_H_
+#define LIVOX_DRIVER_CORE_LIVOX_CODEC_H_
+
+#include <stdint.h>
+
+#include "livox_sdk.h"
+
+/**
+ * Lossless stream codec for LivoxRawPoint.
+ *
+ * The stream is a sequence of self-contained blocks, a decoder can start at
+ * any block boundary. Each block holds up to LIVOX_CODEC_MAX_BLOCK_POINTS
+ * points, usually one Livox packet worth of them:
+ *
+ *   uint8_t  point_count
+ *   uint16_t payload_size        bytes following this field, little endian
+ *   LivoxRawPoint first_point    13 bytes
+ *   bit stream                   4 x 5 bit Rice parameters (x, y, z, reflectivity),
+ *                                then per point the Rice coded zigzag deltas of
+ *                                x, y, z and reflectivity against the previous point
+ */
+
+#define LIVOX_CODEC_FORMAT              "livox_delta_rice"
+#define LIVOX_CODEC_MAX_BLOCK_POINTS    (255)
+#define LIVOX_CODEC_BLOCK_POINTS        (100)     // points of one cartesian eth packet
+
+/** Upper bound of the encoded size of num points. */
+uint32_t LivoxCodecMaxEncodedSize(uint32_t num, uint32_t block_points);
+
+/** Encode num points, return the number of bytes written to out. */
+uint32_t LivoxCodecEncode(const LivoxRawPoint *points, uint32_t num, uint32_t block_points, uint8_t *out);
+
+/** Number of points in an encoded stream, -1 if it is malformed. */
+int32_t LivoxCodecDecodedCount(const uint8_t *in, uint32_t size);
+
+/** Decode up to max_points points, return the number decoded or -1 if the stream is malformed. */
+int32_t LivoxCodecDecode(const uint8_t *in, uint32_t size, LivoxRawPoint *points, uint32_t max_points);
+
+#endif // LIVOX_DRIVER_CORE_LIVOX_CODEC_H_
@@ -0,0 +1,83 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_OUTLIER_FILTER_H_
+#define LIVOX_DRIVER_CORE_OUTLIER_FILTER_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "livox_sdk.h"
+
+/* lengths in meters */
+typedef struct {
+  float radius;                   // neighbor search radius, hash cells are twice as large
+  uint32_t min_neighbors;         // neighbors a point needs within radius up to reference_range
+  float reference_range;          // beyond it the needed neighbors fall with range^2, at least 1
+} OutlierFilterConfig;
+
+/* occupied cell, points cell_points[end - count, end) */
+typedef struct {
+  uint64_t key;
+  uint32_t frame;                 // frame the slot was written in
+  uint32_t end;
+  uint32_t count;
+} OutlierFilterSlot;
+
+/**
+ * Radius outlier test of one frame through a spatial hash. Points are
+ * binned into cells of twice the search radius, a hash table maps each
+ * occupied cell to its points grouped in one array, so a query only visits
+ * the 8 cells around the corner of the cell nearest to the point. Building
+ * and querying are linear in the points of the frame, no tree is built.
+ *
+ * Far points are sparse on Livox lidars, the number of neighbors a point
+ * needs falls with the square of its range beyond reference_range. Points
+ * without return (0, 0, 0) are always kept.
+ */
+typedef struct {
+  OutlierFilterConfig config;
+
+  /* hash table of occupied cells, entries of an older frame are empty */
+  std::vector<OutlierFilterSlot> slots;
+  uint32_t slot_bits;
+  uint32_t frame;
+  std::vector<uint32_t> occupied;     // slots written in this frame
+
+  /* per point scratch of OutlierFilterClassify() */
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<uint32_t> point_slot;
+  std::vector<uint32_t> cell_points;  // point indices grouped by cell
+} OutlierFilter;
+
+void OutlierFilterInit(OutlierFilter *filter, const OutlierFilterConfig &config);
+
+/** Set keep[i] to 0 for outliers, 1 otherwise, returns the outlier count. */
+uint32_t OutlierFilterClassify(OutlierFilter *filter, const LivoxRawPoint *points, uint32_t num,
+                               uint8_t *keep);
+
+#endif // LIVOX_DRIVER_CORE_OUTLIER_FILTER_H_
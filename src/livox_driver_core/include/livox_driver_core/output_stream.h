@@ -0,0 +1,125 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_OUTPUT_STREAM_H_
+#define LIVOX_DRIVER_CORE_OUTPUT_STREAM_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "livox_sdk.h"
+#include <ros/ros.h>
+
+#include "livox_driver_core/point_layout.h"
+
+#define OUTPUT_STREAM_MAX               (8)
+
+struct PointCloudQueue;
+
+typedef struct {
+  uint64_t key;
+  uint32_t frame;                 // frame the slot was written in, 0 never
+} OutputStreamSlot;
+
+/* sensor time of a kept point, points counted from the first point read into its frame */
+typedef struct {
+  uint32_t point;
+  int32_t packet_point;           // first point of its packet, before the frame if negative
+  uint32_t packet_ns;             // sensor time of its packet since the packet of the first point
+} OutputStreamPointTime;
+
+/* frame of one handle under assembly */
+typedef struct {
+  bool active;                    // cursor follows the queue of the handle
+  uint32_t cursor;                // next point of the queue to read
+  uint32_t ingested;              // points of the queue read into this frame
+  uint32_t stamp_rd;              // packet stamp covering the first point
+  ros::Time stamp;                // first point of this frame
+  std::vector<LivoxRawPoint> points;
+  std::vector<OutputStreamSlot> slots;
+  uint32_t voxel_frame;
+
+  /* sensor times of the kept points, for layouts with point times only */
+  bool times_valid;               // every packet read so far had a usable sensor time
+  uint64_t first_packet_ns;       // 0 until the first kept point
+  uint64_t last_packet_ns;
+  uint32_t last_packet_idx;
+  uint32_t point_interval_ns;     // closest packet pair read so far, 0 if none
+  std::vector<OutputStreamPointTime> point_times;
+  std::vector<PacketOffset> offsets;
+  FrameTimes times;
+} OutputStreamFrame;
+
+/**
+ * Extra cloud topic read from the same queues as the main cloud, at its
+ * own frame size and filters, e.g. a dense slow cloud for mapping next to
+ * a sparse fast one for obstacle detection. Every stream keeps its own
+ * cursor per queue and copies the points it keeps straight out of the
+ * queue into its frame, the main cloud never waits for it.
+ *
+ * Streams are listed by name in the private parameter output_streams, each
+ * configured by <name>/frame_points, <name>/decimation, <name>/voxel_size
+ * and <name>/topic (default <topic>_<name>).
+ */
+typedef struct {
+  std::string name;
+  std::string topic;
+  uint32_t frame_points;          // points of the queue per frame
+  uint32_t decimation;            // keep every n-th point
+  float voxel_size;               // m, keep the first point per voxel, 0 keeps all
+  uint32_t slot_bits;
+  bool point_times;               // the layout takes per point sensor times
+  uint32_t seq;
+  ros::Publisher pub;
+  OutputStreamFrame frames[kMaxLidarCount];
+} OutputStream;
+
+extern OutputStream output_streams[OUTPUT_STREAM_MAX];
+extern uint32_t output_stream_count;
+
+void OutputStreamsInit(ros::NodeHandle &private_node, const std::string &topic);
+
+/** Forget the frame of handle, its lidar left or was replaced. */
+void OutputStreamsReleaseHandle(uint8_t handle);
+
+/**
+ * Read the points of handle up to wr_idx into the frame of stream, the
+ * queue must not have been read beyond wr_idx. Returns true when the frame
+ * is complete, publish it and call again.
+ */
+bool OutputStreamAssemble(OutputStream *stream, uint8_t handle, PointCloudQueue *queue, uint32_t wr_idx);
+
+/**
+ * Sensor times of the points of a complete frame, one entry per kept point,
+ * evenly spaced by the queue index if a packet had no sensor time. Valid
+ * until the frame is reset.
+ */
+const FrameTimes *OutputStreamFrameTimes(OutputStreamFrame *frame);
+
+/** Start the next frame of handle after the complete one was published. */
+void OutputStreamFrameReset(OutputStream *stream, OutputStreamFrame *frame);
+
+#endif // LIVOX_DRIVER_CORE_OUTPUT_STREAM_H_
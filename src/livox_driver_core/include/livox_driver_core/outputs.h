@@ -0,0 +1,96 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_OUTPUTS_H_
+#define LIVOX_DRIVER_CORE_OUTPUTS_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "livox_sdk.h"
+#include <ros/ros.h>
+
+#include "livox_driver_core/frame_window.h"
+#include "livox_driver_core/point_fields.h"
+#include "livox_driver_core/point_layout.h"
+
+/**
+ * Optional outputs published next to the main cloud topic, each enabled by
+ * a private parameter of the node:
+ *
+ *   accumulate_window/accumulate_rate  <topic>_accumulated
+ *   compact_format                     <topic>_compact
+ *   compress                           <topic>_compressed
+ *   shm_enable/shm_slots               /livox_<topic basename>_<handle> shared memory rings
+ *   range_image_enable                 <topic>_range_image/{range,intensity,count}
+ *   ground_enable                      livox/ground, livox/obstacles next to <topic>
+ *   map_enable                         <topic>_map, ~save_map service
+ *   grid_enable                        <topic>_grid
+ *
+ * Outputs without subscribers skip their frame work, shared memory rings
+ * and the voxel map always take the frames. The accumulate window and the
+ * height grid take them too and only publish to subscribers.
+ */
+
+typedef enum {
+  kOutputsNeedNone = 0,           // no output takes the frame
+  kOutputsNeedRaw = 1,            // outputs take the raw points only
+  kOutputsNeedCloud = 2,          // outputs take the converted cloud too
+} OutputsNeed;
+
+void OutputsInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic,
+                 uint32_t point_step, const std::vector<sensor_msgs::PointField> *fields);
+void OutputsUninit(void);
+
+/** What the outputs take of the next frame, by their subscribers. Call once before feeding each frame. */
+OutputsNeed OutputsFrameNeed(void);
+
+/** Feed one frame popped from the queue of handle, raw and converted, stamped like the cloud. */
+void OutputsPublishFrame(uint8_t handle, const LivoxRawPoint *raw_points, uint32_t num,
+                         const FrameSegment &segment);
+
+/** Feed one frame of handle that was not converted, stamped at its first point, outputs of the cloud skip it. */
+void OutputsPublishRawFrame(uint8_t handle, const LivoxRawPoint *raw_points, uint32_t num,
+                            const ros::Time &stamp);
+
+/** Release what the outputs keep for handle, its lidar left or was replaced. */
+void OutputsReleaseHandle(uint8_t handle);
+
+/** Rate driven outputs, call once per poll loop. */
+void OutputsPoll(void);
+
+template <typename PointT>
+inline void OutputsInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  OutputsInit(node, private_node, topic, sizeof(PointT), &PointFields<PointT>());
+}
+
+template <typename PointT>
+inline void OutputsPublishFrame(uint8_t handle, const LivoxRawPoint *raw_points, uint32_t num,
+                                const boost::shared_ptr<const LayoutCloud<PointT> > &cloud) {
+  OutputsPublishFrame(handle, raw_points, num, MakeFrameSegment<PointT>(cloud));
+}
+
+#endif // LIVOX_DRIVER_CORE_OUTPUTS_H_
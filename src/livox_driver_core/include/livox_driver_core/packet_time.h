@@ -0,0 +1,105 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_PACKET_TIME_H_
+#define LIVOX_DRIVER_CORE_PACKET_TIME_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "livox_sdk.h"
+
+/**
+ * Timestamps of LivoxEthPacket in nanoseconds, for every TimestampType.
+ *
+ *   kTimestampTypeNoSync  uint64 ns since the lidar powered on
+ *   kTimestampTypePtp     uint64 ns of the ptp master clock
+ *   kTimestampTypePps     uint64 ns, seconds counted from the pps pulses
+ *   kTimestampTypePpsGps  utc: year since 2000, month, day, hour, then
+ *                         uint32 us within the hour, normalized to ns
+ *                         since the unix epoch
+ *
+ * The timestamp field sits at offset 10 of the packed LivoxEthPacket, not
+ * 8 byte aligned, so it is always read with memcpy.
+ */
+
+static inline uint64_t PacketTimeLoad64(const uint8_t *bytes) {
+  uint64_t value;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+static inline uint32_t PacketTimeLoad32(const uint8_t *bytes) {
+  uint32_t value;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+/** Days since 1970-01-01 of a proleptic gregorian date, month 1~12. */
+static inline int64_t PacketTimeDaysFromCivil(int64_t year, uint32_t month, uint32_t day) {
+  year -= (month <= 2);
+  int64_t era = (year >= 0 ? year : year - 399) / 400;
+  uint32_t year_of_era = (uint32_t)(year - era * 400);
+  uint32_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + (int64_t)day_of_era - 719468;
+}
+
+/** Timestamp of packet in ns, false if its type carries no usable time. */
+static inline bool PacketTimeDecode(const LivoxEthPacket *packet, uint64_t *ns) {
+  switch (packet->timestamp_type) {
+    case kTimestampTypeNoSync:
+    case kTimestampTypePtp:
+    case kTimestampTypePps:
+      *ns = PacketTimeLoad64(packet->timestamp);
+      return true;
+    case kTimestampTypePpsGps: {
+      const uint8_t *utc = packet->timestamp;
+      uint32_t month = utc[1];
+      uint32_t day = utc[2];
+      uint32_t hour = utc[3];
+      if ((month < 1) || (month > 12) || (day < 1) || (day > 31) || (hour > 23)) {
+        return false;
+      }
+      int64_t days = PacketTimeDaysFromCivil(2000 + utc[0], month, day);
+      uint64_t hour_ns = ((uint64_t)days * 24 + hour) * 3600ull * 1000000000ull;
+      *ns = hour_ns + (uint64_t)PacketTimeLoad32(utc + 4) * 1000ull;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+static inline const char* PacketTimeTypeName(uint8_t timestamp_type) {
+  switch (timestamp_type) {
+    case kTimestampTypeNoSync: return "no sync";
+    case kTimestampTypePtp: return "ptp";
+    case kTimestampTypePps: return "pps";
+    case kTimestampTypePpsGps: return "pps gps utc";
+    default: return "unknown";
+  }
+}
+
+#endif // LIVOX_DRIVER_CORE_PACKET_TIME_H_
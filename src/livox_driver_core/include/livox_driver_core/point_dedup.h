@@ -0,0 +1,84 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_POINT_DEDUP_H_
+#define LIVOX_DRIVER_CORE_POINT_DEDUP_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <sensor_msgs/PointField.h>
+
+#include "livox_driver_core/frame_window.h"
+
+typedef enum {
+  kDedupKeepReflectivity = 0,     // highest intensity or reflectivity of the cell
+  kDedupKeepClosest = 1,          // closest to the origin of livox_frame
+} DedupPolicy;
+
+typedef struct {
+  uint64_t key;
+  uint32_t frame;                 // snapshot the slot was written in
+  uint32_t point;                 // index of the kept point over all segments
+  float score;                    // higher wins
+} PointDedupSlot;
+
+/**
+ * Keeps one point per voxel of a merged cloud, e.g. of the overlapping
+ * lidars of a hub. The voxels are an open addressing hash table that grows
+ * with the largest cloud seen and is never cleared, slots carry the number
+ * of the snapshot they were written in. Point coordinates and the
+ * reflectivity are read through the PointCloud2 fields of the layout.
+ */
+typedef struct {
+  float resolution;               // m
+  DedupPolicy policy;
+
+  /* layout of the points */
+  uint32_t point_step;
+  uint32_t xyz_offset;
+  bool xyz_mm;                    // int32 mm instead of float32 m
+  int32_t score_offset;           // intensity or reflectivity, -1 if the layout has none
+  uint8_t score_datatype;
+
+  std::vector<PointDedupSlot> slots;
+  uint32_t slot_bits;
+  uint32_t frame;
+  std::vector<uint32_t> occupied;
+  std::vector<uint8_t> keep;
+} PointDedup;
+
+DedupPolicy DedupPolicyFromString(const std::string &name);
+const char *DedupPolicyName(DedupPolicy policy);
+
+/** Returns false if the fields have no x/y/z to bin points by. */
+bool PointDedupInit(PointDedup *dedup, float resolution, DedupPolicy policy, uint32_t point_step,
+                    const std::vector<sensor_msgs::PointField> *fields);
+
+/** Indices of the points to keep over all segments, ascending, into kept. */
+void PointDedupRun(PointDedup *dedup, const std::vector<FrameSegment> &segments, std::vector<uint32_t> *kept);
+
+#endif // LIVOX_DRIVER_CORE_POINT_DEDUP_H_
@@ -0,0 +1,345 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_POINT_LAYOUT_H_
+#define LIVOX_DRIVER_CORE_POINT_LAYOUT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <vector>
+
+#include "livox_sdk.h"
+#include <ros/ros.h>
+#include <std_msgs/Header.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include "livox_driver_core/point_fields.h"
+#include "livox_driver_core/intensity_lut.h"
+
+#define POINT_INTERVAL_NS               (10000)   // ns, 100k points per second of mid-40
+
+/* sensor time of one packet of a frame */
+typedef struct {
+  uint32_t point;                 // first point of the packet in the frame
+  uint32_t offset_ns;             // sensor time of that point since the first point of the frame
+} PacketOffset;
+
+/* sensor times of the points of a frame, packets ascending, packets[0].point is 0 */
+typedef struct {
+  const PacketOffset *packets;
+  uint32_t count;
+  uint32_t point_interval_ns;     // between the points of a packet
+} FrameTimes;
+
+/*
+ * Output point layouts of the cloud topic. Each layout is a plain struct
+ * without padding that goes on the wire as it is, and a traits type whose
+ * Convert() fills a whole frame at once, so every layout compiles to its
+ * own inlined loop without any per-point field dispatch. Layouts with
+ * kIntensity take the intensity from the calibration table of the lidar, if
+ * any; the others are passed no table.
+ * Layouts with kPointTimes take the sensor times of the frame, NULL leaves
+ * them at 0.
+ */
+typedef struct {
+  float x;
+  float y;
+  float z;
+} LivoxPointXYZ;
+
+typedef struct {
+  float x;
+  float y;
+  float z;
+  float intensity;
+} LivoxPointXYZI;
+
+typedef struct {
+  float x;
+  float y;
+  float z;
+  float intensity;
+  uint32_t offset_time;      // ns since the first point of the frame
+} LivoxPointXYZIT;
+
+#pragma pack(1)
+typedef struct {
+  int32_t x;                 // mm
+  int32_t y;                 // mm
+  int32_t z;                 // mm
+  uint8_t reflectivity;
+} LivoxPointXYZR;
+#pragma pack()
+
+typedef struct {
+  float x;
+  float y;
+  float z;
+  float intensity;
+  uint8_t lidar;             // handle of the lidar the point comes from
+  uint8_t reserved[3];
+} LivoxPointXYZIL;
+
+struct PointLayoutXYZ {
+  typedef LivoxPointXYZ Point;
+  static const bool kPointTimes = false;
+  static const bool kIntensity = false;
+
+  static inline void Convert(Point *out, const LivoxRawPoint *raw, uint32_t num, uint8_t handle,
+                             const IntensityLut *lut, const FrameTimes *times) {
+    for (uint32_t i = 0; i < num; i++) {
+      out[i].x = raw[i].x/1000.0f;
+      out[i].y = raw[i].y/1000.0f;
+      out[i].z = raw[i].z/1000.0f;
+    }
+  }
+};
+
+struct PointLayoutXYZI {
+  typedef LivoxPointXYZI Point;
+  static const bool kPointTimes = false;
+  static const bool kIntensity = true;
+
+  static inline void Convert(Point *out, const LivoxRawPoint *raw, uint32_t num, uint8_t handle,
+                             const IntensityLut *lut, const FrameTimes *times) {
+    for (uint32_t i = 0; i < num; i++) {
+      out[i].x = raw[i].x/1000.0f;
+      out[i].y = raw[i].y/1000.0f;
+      out[i].z = raw[i].z/1000.0f;
+      out[i].intensity = (float) raw[i].reflectivity;
+    }
+    if (lut) {
+      IntensityLutApply(lut, &out[0].intensity, sizeof(Point), raw, num);
+    }
+  }
+};
+
+struct PointLayoutXYZIT {
+  typedef LivoxPointXYZIT Point;
+  static const bool kPointTimes = true;
+  static const bool kIntensity = true;
+
+  /* points of a packet are evenly spaced from the sensor time of the packet */
+  static inline void Convert(Point *out, const LivoxRawPoint *raw, uint32_t num, uint8_t handle,
+                             const IntensityLut *lut, const FrameTimes *times) {
+    for (uint32_t i = 0; i < num; i++) {
+      out[i].x = raw[i].x/1000.0f;
+      out[i].y = raw[i].y/1000.0f;
+      out[i].z = raw[i].z/1000.0f;
+      out[i].intensity = (float) raw[i].reflectivity;
+    }
+    if (!times) {
+      for (uint32_t i = 0; i < num; i++) {
+        out[i].offset_time = 0;
+      }
+    } else {
+      for (uint32_t k = 0; k < times->count; k++) {
+        const PacketOffset *packet = &times->packets[k];
+        uint32_t end = (k + 1 < times->count) ? times->packets[k + 1].point : num;
+        for (uint32_t i = packet->point; i < end; i++) {
+          out[i].offset_time = packet->offset_ns + (i - packet->point) * times->point_interval_ns;
+        }
+      }
+    }
+    if (lut) {
+      IntensityLutApply(lut, &out[0].intensity, sizeof(Point), raw, num);
+    }
+  }
+};
+
+struct PointLayoutXYZR {
+  typedef LivoxPointXYZR Point;
+  static const bool kPointTimes = false;
+  static const bool kIntensity = false;
+
+  /* same layout as LivoxRawPoint */
+  static inline void Convert(Point *out, const LivoxRawPoint *raw, uint32_t num, uint8_t handle,
+                             const IntensityLut *lut, const FrameTimes *times) {
+    memcpy(out, raw, num * sizeof(Point));
+  }
+};
+
+struct PointLayoutXYZIL {
+  typedef LivoxPointXYZIL Point;
+  static const bool kPointTimes = false;
+  static const bool kIntensity = true;
+
+  static inline void Convert(Point *out, const LivoxRawPoint *raw, uint32_t num, uint8_t handle,
+                             const IntensityLut *lut, const FrameTimes *times) {
+    for (uint32_t i = 0; i < num; i++) {
+      out[i].x = raw[i].x/1000.0f;
+      out[i].y = raw[i].y/1000.0f;
+      out[i].z = raw[i].z/1000.0f;
+      out[i].intensity = (float) raw[i].reflectivity;
+      out[i].lidar = handle;
+      out[i].reserved[0] = 0;
+      out[i].reserved[1] = 0;
+      out[i].reserved[2] = 0;
+    }
+    if (lut) {
+      IntensityLutApply(lut, &out[0].intensity, sizeof(Point), raw, num);
+    }
+  }
+};
+
+template <>
+inline const std::vector<sensor_msgs::PointField>& PointFields<LivoxPointXYZ>() {
+  static std::vector<sensor_msgs::PointField> fields;
+  if (fields.empty()) {
+    AddPointField(&fields, "x", offsetof(LivoxPointXYZ, x), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "y", offsetof(LivoxPointXYZ, y), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "z", offsetof(LivoxPointXYZ, z), sensor_msgs::PointField::FLOAT32);
+  }
+  return fields;
+}
+
+template <>
+inline const std::vector<sensor_msgs::PointField>& PointFields<LivoxPointXYZI>() {
+  static std::vector<sensor_msgs::PointField> fields;
+  if (fields.empty()) {
+    AddPointField(&fields, "x", offsetof(LivoxPointXYZI, x), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "y", offsetof(LivoxPointXYZI, y), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "z", offsetof(LivoxPointXYZI, z), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "intensity", offsetof(LivoxPointXYZI, intensity), sensor_msgs::PointField::FLOAT32);
+  }
+  return fields;
+}
+
+template <>
+inline const std::vector<sensor_msgs::PointField>& PointFields<LivoxPointXYZIT>() {
+  static std::vector<sensor_msgs::PointField> fields;
+  if (fields.empty()) {
+    AddPointField(&fields, "x", offsetof(LivoxPointXYZIT, x), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "y", offsetof(LivoxPointXYZIT, y), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "z", offsetof(LivoxPointXYZIT, z), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "intensity", offsetof(LivoxPointXYZIT, intensity), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "offset_time", offsetof(LivoxPointXYZIT, offset_time), sensor_msgs::PointField::UINT32);
+  }
+  return fields;
+}
+
+template <>
+inline const std::vector<sensor_msgs::PointField>& PointFields<LivoxPointXYZR>() {
+  static std::vector<sensor_msgs::PointField> fields;
+  if (fields.empty()) {
+    AddPointField(&fields, "x", offsetof(LivoxPointXYZR, x), sensor_msgs::PointField::INT32);
+    AddPointField(&fields, "y", offsetof(LivoxPointXYZR, y), sensor_msgs::PointField::INT32);
+    AddPointField(&fields, "z", offsetof(LivoxPointXYZR, z), sensor_msgs::PointField::INT32);
+    AddPointField(&fields, "reflectivity", offsetof(LivoxPointXYZR, reflectivity), sensor_msgs::PointField::UINT8);
+  }
+  return fields;
+}
+
+template <>
+inline const std::vector<sensor_msgs::PointField>& PointFields<LivoxPointXYZIL>() {
+  static std::vector<sensor_msgs::PointField> fields;
+  if (fields.empty()) {
+    AddPointField(&fields, "x", offsetof(LivoxPointXYZIL, x), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "y", offsetof(LivoxPointXYZIL, y), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "z", offsetof(LivoxPointXYZIL, z), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "intensity", offsetof(LivoxPointXYZIL, intensity), sensor_msgs::PointField::FLOAT32);
+    AddPointField(&fields, "lidar", offsetof(LivoxPointXYZIL, lidar), sensor_msgs::PointField::UINT8);
+  }
+  return fields;
+}
+
+/**
+ * One frame of the cloud topic in a point layout. It goes on the wire as a
+ * sensor_msgs/PointCloud2, the points are written with a single copy.
+ */
+template <typename PointT>
+struct LayoutCloud {
+  std_msgs::Header header;
+  std::vector<PointT> points;
+};
+
+namespace ros {
+namespace message_traits {
+
+template<typename PointT> struct MD5Sum<LayoutCloud<PointT> > {
+  static const char* value() { return MD5Sum<sensor_msgs::PointCloud2>::value(); }
+  static const char* value(const LayoutCloud<PointT>&) { return value(); }
+};
+
+template<typename PointT> struct DataType<LayoutCloud<PointT> > {
+  static const char* value() { return DataType<sensor_msgs::PointCloud2>::value(); }
+  static const char* value(const LayoutCloud<PointT>&) { return value(); }
+};
+
+template<typename PointT> struct Definition<LayoutCloud<PointT> > {
+  static const char* value() { return Definition<sensor_msgs::PointCloud2>::value(); }
+  static const char* value(const LayoutCloud<PointT>&) { return value(); }
+};
+
+} // namespace message_traits
+
+namespace serialization {
+
+template<typename PointT> struct Serializer<LayoutCloud<PointT> > {
+  template<typename Stream>
+  inline static void write(Stream& stream, const LayoutCloud<PointT>& m) {
+    uint32_t width = m.points.size();
+    uint32_t data_size = sizeof(PointT) * width;
+
+    stream.next(m.header);
+    stream.next((uint32_t)1);
+    stream.next(width);
+    stream.next(PointFields<PointT>());
+    stream.next((uint8_t)0);
+    stream.next((uint32_t)sizeof(PointT));
+    stream.next(data_size);
+
+    stream.next(data_size);
+    if (data_size) {
+      memcpy(stream.advance(data_size), &m.points[0], data_size);
+    }
+
+    stream.next((uint8_t)1);
+  }
+
+  template<typename Stream>
+  inline static void read(Stream& stream, LayoutCloud<PointT>& m) {
+    /* publish only, subscribers receive a plain sensor_msgs/PointCloud2 */
+  }
+
+  inline static uint32_t serializedLength(const LayoutCloud<PointT>& m) {
+    uint32_t length = 0;
+
+    length += serializationLength(m.header);
+    length += 4 + 4;                        // height, width
+    length += serializationLength(PointFields<PointT>());
+    length += 1 + 4 + 4;                    // is_bigendian, point_step, row_step
+    length += 4 + sizeof(PointT) * m.points.size();
+    length += 1;                            // is_dense
+
+    return length;
+  }
+};
+
+} // namespace serialization
+} // namespace ros
+
+#endif // LIVOX_DRIVER_CORE_POINT_LAYOUT_H_
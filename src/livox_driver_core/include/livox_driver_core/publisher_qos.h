@@ -0,0 +1,54 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_PUBLISHER_QOS_H_
+#define LIVOX_DRIVER_CORE_PUBLISHER_QOS_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include <ros/ros.h>
+
+/**
+ * Delivery policy of the frame rate topics (cloud, metadata, compact,
+ * compressed, ground/obstacles), set by the publish_qos private parameter:
+ *   keep_last  every subscriber queues up to publish_queue_size frames
+ *   latest     every subscriber queues one frame, a new frame replaces it
+ * roscpp drops the oldest frame of a full subscriber queue, memory and
+ * latency stay bounded whatever the subscriber does.
+ *
+ * roscpp does not report those drops to the publisher. Subscribers started
+ * with /enable_statistics report delivered and dropped messages (header seq
+ * gaps) and message age on /statistics, the reports about this node are
+ * accounted per subscriber, republished on <topic>_qos and a subscriber that
+ * drops frames or lags behind slow_subscriber_age is logged as slow.
+ */
+
+void PublisherQosInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic);
+
+/** Queue size to advertise the frame rate topics with. */
+uint32_t PublisherQosQueueSize(void);
+
+#endif // LIVOX_DRIVER_CORE_PUBLISHER_QOS_H_
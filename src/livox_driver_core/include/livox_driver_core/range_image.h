@@ -0,0 +1,67 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_RANGE_IMAGE_H_
+#define LIVOX_DRIVER_CORE_RANGE_IMAGE_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "livox_sdk.h"
+
+/* angles in radians, azimuth grows to +y, elevation to +z, x points forward */
+typedef struct {
+  float azimuth_min;
+  float azimuth_max;
+  float elevation_min;
+  float elevation_max;
+  uint32_t cols;
+  uint32_t rows;
+} RangeImageConfig;
+
+/**
+ * Azimuth/elevation grid of one frame. Each cell keeps the closest
+ * point (range, intensity) and the number of points binned into it.
+ * Row 0 is elevation_max, column 0 is azimuth_max, so the image looks
+ * like the scene seen from the lidar.
+ */
+typedef struct {
+  RangeImageConfig config;
+  std::vector<float> range;         // m, 0 if empty
+  std::vector<uint8_t> intensity;
+  std::vector<uint16_t> count;
+
+  /* per point scratch of RangeImageProject(), points in meters */
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<int32_t> cell;
+  std::vector<float> point_range;
+} RangeImage;
+
+void RangeImageInit(RangeImage *image, const RangeImageConfig &config);
+void RangeImageProject(RangeImage *image, const LivoxRawPoint *points, uint32_t num);
+
+#endif // LIVOX_DRIVER_CORE_RANGE_IMAGE_H_
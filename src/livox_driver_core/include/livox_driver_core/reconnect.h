@@ -0,0 +1,67 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_RECONNECT_H_
+#define LIVOX_DRIVER_CORE_RECONNECT_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include <ros/ros.h>
+
+#include "livox_driver_core/driver_core.h"
+
+/**
+ * Reconnect state machine of the devices of a node, lidars connected
+ * directly or the hub.
+ *
+ * OnDeviceChange reports disconnect and connect events and only moves a
+ * device to connect. The ros thread sends the start command to a device
+ * that is connected and normal, and again after a backoff that doubles
+ * from reconnect_backoff_min to reconnect_backoff_max while the command
+ * fails or times out, so no two threads ever start the same device. The
+ * queues of a device are flushed (default) or kept after its disconnect by
+ * reconnect_ring_policy. Once
+ * the first point after a reconnect arrives, the outage and time to first
+ * point are published on <topic>_reconnect.
+ */
+
+/**
+ * Move device from connect to sampling and send the start sampling command,
+ * provided by the node. A failed command moves it back to connect.
+ */
+typedef void (*StartSamplingFunc)(DeviceItem *device);
+
+void ReconnectInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic,
+                   StartSamplingFunc start_sampling);
+
+/** Call from OnDeviceChange of the sdk thread, on kEventDisconnect and kEventConnect. */
+void ReconnectOnDisconnect(DeviceItem *device);
+void ReconnectOnConnect(DeviceItem *device);
+
+/** Retry sampling, flush and report, from the ros thread before the queues are polled. */
+void ReconnectPoll(void);
+
+#endif // LIVOX_DRIVER_CORE_RECONNECT_H_
@@ -0,0 +1,103 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_SHM_RING_H_
+#define LIVOX_DRIVER_CORE_SHM_RING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * POSIX shared-memory frame ring, one per lidar handle.
+ *
+ * The writer owns the ring, readers map it and keep their own read cursor,
+ * like rd_idx of PointCloudQueue but across processes. Frames are read in
+ * place: ShmRingAcquire() gives a view of a slot and ShmRingValidate()
+ * tells whether the writer overwrote it in the meantime (per slot seqlock).
+ * Readers block on the futex word of the header until a new frame is written.
+ *
+ * Only libc/librt are needed, so non-ROS processes can include this header
+ * and link shm_ring.cpp.
+ */
+
+#define SHM_RING_MAGIC                  (0x5856494c) // "LIVX"
+#define SHM_RING_VERSION                (1)
+#define SHM_RING_NAME_SIZE              (32)
+
+/* point in meters, 16 bytes so it stays aligned in the slot */
+typedef struct {
+  float x;
+  float y;
+  float z;
+  float intensity;
+} ShmPoint;
+
+typedef struct {
+  volatile uint32_t lock;           // odd while the writer fills the slot
+  uint32_t point_count;
+  volatile uint64_t frame_seq;      // sequence number of the frame in the slot
+  uint64_t stamp_ns;
+} ShmFrameHeader;                   // followed by slot_points ShmPoint
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t handle;
+  uint32_t slot_count;              // must be 2^n
+  uint32_t slot_points;
+  uint32_t slot_size;               // bytes of one slot, header and points
+  volatile uint32_t futex;          // bumped on every frame, readers wait on it
+  uint32_t reserved;
+  volatile uint64_t write_seq;      // number of frames written so far
+} ShmRingHeader;                    // followed by slot_count slots
+
+typedef struct {
+  int fd;
+  uint8_t *base;
+  size_t size;
+  int owner;
+  char name[SHM_RING_NAME_SIZE];
+} ShmRing;
+
+typedef struct {
+  const ShmFrameHeader *frame;
+  const ShmPoint *points;
+  uint32_t lock;
+} ShmFrameView;
+
+/* for writer use */
+int ShmRingCreate(ShmRing *ring, const char *name, uint32_t handle, uint32_t slot_count, uint32_t slot_points);
+ShmPoint* ShmRingBeginWrite(ShmRing *ring);
+void ShmRingEndWrite(ShmRing *ring, uint32_t point_count, uint64_t stamp_ns);
+void ShmRingDestroy(ShmRing *ring);
+
+/* for reader use */
+int ShmRingOpen(ShmRing *ring, const char *name);
+void ShmRingClose(ShmRing *ring);
+uint64_t ShmRingWriteSeq(const ShmRing *ring);
+int ShmRingWait(ShmRing *ring, uint64_t frame_seq, int timeout_ms);
+int ShmRingAcquire(const ShmRing *ring, uint64_t frame_seq, ShmFrameView *view);
+int ShmRingValidate(const ShmFrameView *view);
+
+#endif // LIVOX_DRIVER_CORE_SHM_RING_H_
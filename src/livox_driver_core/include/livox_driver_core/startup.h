@@ -0,0 +1,74 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_STARTUP_H_
+#define LIVOX_DRIVER_CORE_STARTUP_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include <ros/ros.h>
+
+/**
+ * Startup timeline and readiness barrier of the devices of a node.
+ *
+ * Every device is brought up by its own sdk callbacks, so the devices come
+ * up concurrently and the node only has to wait for the slowest one. The
+ * callbacks stamp the phases of each device handle: broadcast, connect,
+ * info, sampling and first packet. The timeline is published latched on
+ * <topic>_startup whenever a device sends its first packet, and it is
+ * ready once startup_expected_devices devices did. Behind a hub the devices
+ * are the lidars: the hub has the broadcast, connect, info and sampling
+ * phases, each lidar the connect phase of its topology entry and the first
+ * packet, so the hub itself never counts.
+ */
+
+typedef enum {
+  kStartupBroadcast = 0,
+  kStartupConnect = 1,
+  kStartupInfo = 2,
+  kStartupSampling = 3,
+  kStartupFirstPacket = 4,
+  kStartupPhaseNum = 5,
+} StartupPhase;
+
+/** Start the clock of the timeline, call first thing in main. */
+void StartupBegin(void);
+
+void StartupInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic);
+
+/** Stamp phase of device handle, from the sdk callbacks. Only the first stamp of a phase is kept. */
+void StartupStamp(uint8_t handle, StartupPhase phase);
+
+/** Stamp the broadcast phase and remember the broadcast code of handle. */
+void StartupOnBroadcast(uint8_t handle, const char *broadcast_code);
+
+/** Stamp the connect phase of a lidar that showed up behind the hub, from the ros thread. */
+void StartupOnHubLidar(uint8_t handle, const char *broadcast_code);
+
+/** Publish the timeline when a device sent its first packet, from the ros thread. */
+void StartupPoll(void);
+
+#endif // LIVOX_DRIVER_CORE_STARTUP_H_
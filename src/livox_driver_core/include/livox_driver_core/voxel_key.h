@@ -0,0 +1,52 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_VOXEL_KEY_H_
+#define LIVOX_DRIVER_CORE_VOXEL_KEY_H_
+
+#include <stdint.h>
+
+/* integer voxel coordinates packed into one 64 bit hash key */
+#define VOXEL_KEY_BITS                  (21)      // per axis, 200 km at 0.1 m voxels
+#define VOXEL_KEY_BIAS                  (1 << (VOXEL_KEY_BITS - 1))
+#define VOXEL_KEY_MASK                  ((1 << VOXEL_KEY_BITS) - 1)
+
+static inline uint64_t VoxelKey(int32_t vx, int32_t vy, int32_t vz) {
+  return ((uint64_t)((vx + VOXEL_KEY_BIAS) & VOXEL_KEY_MASK) << (2 * VOXEL_KEY_BITS)) |
+         ((uint64_t)((vy + VOXEL_KEY_BIAS) & VOXEL_KEY_MASK) << VOXEL_KEY_BITS) |
+         (uint64_t)((vz + VOXEL_KEY_BIAS) & VOXEL_KEY_MASK);
+}
+
+static inline void VoxelKeyDecode(uint64_t key, int32_t *vx, int32_t *vy, int32_t *vz) {
+  *vx = (int32_t)((key >> (2 * VOXEL_KEY_BITS)) & VOXEL_KEY_MASK) - VOXEL_KEY_BIAS;
+  *vy = (int32_t)((key >> VOXEL_KEY_BITS) & VOXEL_KEY_MASK) - VOXEL_KEY_BIAS;
+  *vz = (int32_t)(key & VOXEL_KEY_MASK) - VOXEL_KEY_BIAS;
+}
+
+/* slot of key in an open addressing table of 2^bits slots */
+static inline uint32_t VoxelKeyHash(uint64_t key, uint32_t bits) {
+  return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+}
+
+#endif // LIVOX_DRIVER_CORE_VOXEL_KEY_H_
@@ -0,0 +1,67 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_DRIVER_CORE_VOXEL_MAP_H_
+#define LIVOX_DRIVER_CORE_VOXEL_MAP_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "livox_sdk.h"
+#include <sensor_msgs/PointCloud2.h>
+
+/* one voxel of the map, empty while hits is 0 */
+typedef struct {
+  uint64_t key;
+  uint32_t hits;
+  float intensity;                // mean reflectivity of the hits
+} VoxelMapCell;
+
+/**
+ * Voxel map integrating every frame, for surveys from a parked vehicle.
+ * Voxels live in an open addressing hash table sized once for max_voxels,
+ * so memory is fixed at init. Once the map holds max_voxels, points of
+ * new voxels are counted as dropped and the known voxels keep integrating.
+ */
+typedef struct {
+  float voxel_size;               // m
+  uint32_t max_voxels;
+  uint32_t voxel_count;
+  uint64_t point_count;           // points integrated
+  uint64_t dropped_points;        // points of new voxels after the map was full
+  uint32_t slot_bits;
+  std::vector<VoxelMapCell> cells;
+} VoxelMap;
+
+void VoxelMapInit(VoxelMap *map, float voxel_size, uint32_t max_voxels);
+void VoxelMapInsert(VoxelMap *map, const LivoxRawPoint *points, uint32_t num);
+
+/** Fill cloud with the voxel centers, x/y/z/intensity float32 and hits uint32. */
+void VoxelMapSnapshot(const VoxelMap *map, sensor_msgs::PointCloud2 *cloud);
+
+/** Write the map as a binary pcd file, same fields as the snapshot. Returns 0 on success. */
+int VoxelMapSave(const VoxelMap *map, const char *path);
+
+#endif // LIVOX_DRIVER_CORE_VOXEL_MAP_H_
@@ -0,0 +1,185 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "livox_sdk.h"
+#include <ros/ros.h>
+#include <std_srvs/Trigger.h>
+
+#include "livox_driver_core/broadcast_code.h"
+
+#define BD_SET_MIN_SLOTS                (16)      // must be 2^n
+
+std::vector<std::string > total_broadcast_code;
+
+/* bd of the private param broadcast_codes, replaced on reload */
+static std::vector<std::string > param_broadcast_code;
+
+/* open addressing hash set of bd, at most half full */
+typedef struct {
+  std::vector<std::string > slots;
+  uint32_t mask;
+} BroadcastCodeSet;
+
+/*
+ * OnDeviceBroadcast of the sdk thread looks up the current set while the
+ * reload service of the ros thread builds a new one, the mutex only guards
+ * swapping the pointer.
+ */
+static boost::shared_ptr<const BroadcastCodeSet> broadcast_code_set(new BroadcastCodeSet());
+static boost::mutex broadcast_code_set_mutex;
+static ros::ServiceServer reload_broadcast_code_srv;
+
+/* FNV-1a of the bd */
+static uint32_t broadcast_code_hash(const char* bd_str) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < kBroadcastCodeSize && bd_str[i]; ++i) {
+    hash = (hash ^ (uint8_t)bd_str[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static bool broadcast_code_set_find(const BroadcastCodeSet* set, const char* bd_str, uint32_t* slot) {
+  uint32_t i = broadcast_code_hash(bd_str) & set->mask;
+  while (!set->slots[i].empty()) {
+    if (strncmp(bd_str, set->slots[i].c_str(), kBroadcastCodeSize) == 0) {
+      *slot = i;
+      return true;
+    }
+    i = (i + 1) & set->mask;
+  }
+  *slot = i;
+  return false;
+}
+
+static void broadcast_code_set_insert(BroadcastCodeSet* set, const std::string& bd) {
+  uint32_t slot;
+  if (!broadcast_code_set_find(set, bd.c_str(), &slot)) {
+    set->slots[slot] = bd;
+  }
+}
+
+static void rebuild_broadcast_code_set(void) {
+  uint32_t count = total_broadcast_code.size() + param_broadcast_code.size();
+  uint32_t size = BD_SET_MIN_SLOTS;
+  while (size < count * 2) {
+    size <<= 1;
+  }
+
+  BroadcastCodeSet* set = new BroadcastCodeSet();
+  set->slots.resize(size);
+  set->mask = size - 1;
+  for (size_t i = 0; i < total_broadcast_code.size(); ++i) {
+    broadcast_code_set_insert(set, total_broadcast_code[i]);
+  }
+  for (size_t i = 0; i < param_broadcast_code.size(); ++i) {
+    broadcast_code_set_insert(set, param_broadcast_code[i]);
+  }
+
+  boost::shared_ptr<const BroadcastCodeSet> new_set(set);
+  boost::mutex::scoped_lock lock(broadcast_code_set_mutex);
+  broadcast_code_set.swap(new_set);
+}
+
+static void load_param_broadcast_code(ros::NodeHandle &private_node) {
+  std::vector<std::string > param_list;
+  private_node.getParam("broadcast_codes", param_list);
+
+  param_broadcast_code.clear();
+  for (size_t i = 0; i < param_list.size(); ++i) {
+    if (COMMANDLINE_BD_SIZE == param_list[i].size()) {
+      param_broadcast_code.push_back(param_list[i]);
+    } else {
+      ROS_INFO("Invalid bd:%s", param_list[i].c_str());
+    }
+  }
+  rebuild_broadcast_code_set();
+}
+
+static bool on_reload_broadcast_code(std_srvs::Trigger::Request& request, std_srvs::Trigger::Response& response) {
+  ros::NodeHandle private_node("~");
+  load_param_broadcast_code(private_node);
+
+  char message[64];
+  snprintf(message, sizeof(message), "%u param bd, %u total bd",
+           (uint32_t)param_broadcast_code.size(),
+           (uint32_t)(param_broadcast_code.size() + total_broadcast_code.size()));
+  ROS_INFO("Reload broadcast codes, %s", message);
+  response.success = true;
+  response.message = message;
+  return true;
+}
+
+void add_broadcast_code(const char* bd_str) {
+  total_broadcast_code.push_back(bd_str);
+  rebuild_broadcast_code_set();
+}
+
+void add_local_broadcast_code(const char** bd_list, int bd_list_size) {
+  for (int i = 0; i < bd_list_size; ++i) {
+    add_broadcast_code(bd_list[i]);
+  }
+}
+
+void add_commandline_broadcast_code(const char* cammandline_str) {
+  char* strs = new char[strlen(cammandline_str) + 1];
+  strcpy(strs, cammandline_str);
+
+  std::string pattern = "&";
+  char* bd_str  = strtok(strs, pattern.c_str());
+  while (bd_str != NULL) {
+    ROS_INFO("commandline input bd:%s", bd_str);
+    if (COMMANDLINE_BD_SIZE == strlen(bd_str)) {
+      add_broadcast_code(bd_str);
+    } else {
+      ROS_INFO("Invalid bd:%s", bd_str);
+    }
+    bd_str = strtok(NULL, pattern.c_str());
+  }
+
+  delete [] strs;
+}
+
+void init_param_broadcast_code(ros::NodeHandle &private_node) {
+  load_param_broadcast_code(private_node);
+  ROS_INFO("%u bd in param broadcast_codes", (uint32_t)param_broadcast_code.size());
+  reload_broadcast_code_srv = private_node.advertiseService("reload_broadcast_codes", on_reload_broadcast_code);
+}
+
+bool is_broadcast_code_accepted(const char* bd_str) {
+  boost::shared_ptr<const BroadcastCodeSet> set;
+  {
+    boost::mutex::scoped_lock lock(broadcast_code_set_mutex);
+    set = broadcast_code_set;
+  }
+
+  uint32_t slot;
+  return !set->slots.empty() && broadcast_code_set_find(set.get(), bd_str, &slot);
+}
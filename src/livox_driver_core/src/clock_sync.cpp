@@ -0,0 +1,162 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string.h>
+#include <math.h>
+
+#include "livox_driver_core/clock_sync.h"
+
+void ClockSyncReset(ClockSync *sync) {
+  uint32_t resets = sync->resets;
+  memset(sync, 0, sizeof(*sync));
+  sync->resets = resets;
+}
+
+/* least squares line through the bucket minima */
+static void ClockSyncFit(ClockSync *sync) {
+  uint32_t n = (sync->bucket_count < CLOCK_SYNC_BUCKETS) ? sync->bucket_count : CLOCK_SYNC_BUCKETS;
+  double mean_x = 0;
+  double mean_y = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    mean_x += sync->bucket_sensor[i];
+    mean_y += sync->bucket_delay[i];
+  }
+  mean_x /= n;
+  mean_y /= n;
+
+  double sxx = 0;
+  double sxy = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    double dx = sync->bucket_sensor[i] - mean_x;
+    sxx += dx * dx;
+    sxy += dx * (sync->bucket_delay[i] - mean_y);
+  }
+
+  sync->drift = (n > 1 && sxx > 0) ? sxy / sxx : 0;
+  sync->offset = mean_y - sync->drift * mean_x;
+
+  double sum_sq = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    double residual = sync->bucket_delay[i] - (sync->offset + sync->drift * sync->bucket_sensor[i]);
+    sum_sq += residual * residual;
+  }
+  sync->fit_rms = sqrt(sum_sq / n);
+  sync->fitted = true;
+}
+
+static double ClockSyncDelay(const ClockSync *sync, int64_t sensor) {
+  if (sync->fitted) {
+    return sync->offset + sync->drift * sensor;
+  }
+  return (double)sync->open_min_delay;
+}
+
+bool ClockSyncMap(const ClockSync *sync, uint64_t sensor_ns, uint64_t *ros_ns) {
+  if (!sync->started) {
+    return false;
+  }
+
+  int64_t sensor = (int64_t)sensor_ns - sync->base_sensor;
+  int64_t delay = sync->base_delay + (int64_t)llround(ClockSyncDelay(sync, sensor));
+  *ros_ns = sensor_ns + delay;
+  return true;
+}
+
+bool ClockSyncAdd(ClockSync *sync, uint64_t sensor_ns, uint64_t arrival_ns) {
+  int64_t delay = (int64_t)(arrival_ns - sensor_ns);
+
+  if (sync->started) {
+    /* sensor clock restarted or resynced, the old line is useless */
+    int64_t sensor = (int64_t)sensor_ns - sync->base_sensor;
+    double expected = ClockSyncDelay(sync, sensor);
+    if ((sensor < sync->last_sensor - CLOCK_SYNC_RESET_NS) ||
+        ((delay - sync->base_delay) - expected < -CLOCK_SYNC_RESET_NS)) {
+      sync->resets++;
+      ClockSyncReset(sync);
+    }
+  }
+
+  if (!sync->started) {
+    sync->started = true;
+    sync->base_delay = delay;
+    sync->base_sensor = sensor_ns;
+    sync->open_end = CLOCK_SYNC_BUCKET_NS;
+    sync->open_min_delay = 0;
+    sync->open_min_sensor = 0;
+  }
+
+  int64_t sensor = (int64_t)sensor_ns - sync->base_sensor;
+  delay -= sync->base_delay;
+
+  if (sensor > sync->last_sensor) {
+    sync->last_sensor = sensor;
+  }
+
+  bool closed = false;
+  if (sensor >= sync->open_end) {
+    /* even the least delayed packet of the bucket came late, a stall unless it lasts */
+    double excess = sync->open_min_delay - ClockSyncDelay(sync, sync->open_min_sensor);
+    if (sync->fitted && (excess > CLOCK_SYNC_RESET_NS)) {
+      if (++sync->high_buckets >= CLOCK_SYNC_RESET_BUCKETS) {
+        sync->resets++;
+        ClockSyncReset(sync);
+        return ClockSyncAdd(sync, sensor_ns, arrival_ns);
+      }
+    } else {
+      uint32_t slot = sync->bucket_count % CLOCK_SYNC_BUCKETS;
+      sync->bucket_sensor[slot] = (double)sync->open_min_sensor;
+      sync->bucket_delay[slot] = (double)sync->open_min_delay;
+      sync->bucket_count++;
+      sync->high_buckets = 0;
+      ClockSyncFit(sync);
+    }
+
+    sync->last_residual_mean = sync->residual_count ? sync->residual_sum / sync->residual_count : 0;
+    sync->last_residual_max = sync->residual_max;
+    sync->last_samples = sync->open_samples;
+    sync->residual_sum = 0;
+    sync->residual_max = 0;
+    sync->residual_count = 0;
+
+    sync->open_end = sensor - sensor % CLOCK_SYNC_BUCKET_NS + CLOCK_SYNC_BUCKET_NS;
+    sync->open_samples = 0;
+    closed = true;
+  }
+
+  if (!sync->open_samples || (delay < sync->open_min_delay)) {
+    sync->open_min_delay = delay;
+    sync->open_min_sensor = sensor;
+  }
+  sync->open_samples++;
+
+  /* delay above the line, transport and scheduling latency of this packet */
+  double residual = delay - ClockSyncDelay(sync, sensor);
+  sync->residual_sum += residual;
+  if (residual > sync->residual_max) {
+    sync->residual_max = residual;
+  }
+  sync->residual_count++;
+
+  return closed;
+}
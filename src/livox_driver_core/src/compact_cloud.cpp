@@ -0,0 +1,111 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string.h>
+
+#include "livox_driver_core/compact_cloud.h"
+#include "livox_driver_core/point_fields.h"
+
+CompactFormat CompactFormatFromString(const std::string &name) {
+  if (name == "int32_mm") {
+    return kCompactFormatInt32Mm;
+  } else if (name == "int16_cm") {
+    return kCompactFormatInt16Cm;
+  }
+  return kCompactFormatNone;
+}
+
+const char* CompactFormatName(CompactFormat format) {
+  switch (format) {
+    case kCompactFormatInt32Mm: return "int32_mm";
+    case kCompactFormatInt16Cm: return "int16_cm";
+    default: return "none";
+  }
+}
+
+double CompactFormatScale(CompactFormat format) {
+  switch (format) {
+    case kCompactFormatInt32Mm: return 0.001;
+    case kCompactFormatInt16Cm: return 0.01;
+    default: return 1.0;
+  }
+}
+
+static inline int16_t RoundMmToCm(int32_t mm) {
+  return (int16_t)((mm >= 0) ? ((mm + 5) / 10) : ((mm - 5) / 10));
+}
+
+uint32_t CompactCloudFill(sensor_msgs::PointCloud2 *msg, CompactFormat format,
+                          const LivoxRawPoint *points, uint32_t num) {
+  uint32_t dropped = 0;
+
+  msg->height = 1;
+  msg->is_bigendian = false;
+  msg->is_dense = true;
+  msg->fields.clear();
+
+  if (format == kCompactFormatInt32Mm) {
+    AddPointField(&msg->fields, "x", 0, sensor_msgs::PointField::INT32);
+    AddPointField(&msg->fields, "y", 4, sensor_msgs::PointField::INT32);
+    AddPointField(&msg->fields, "z", 8, sensor_msgs::PointField::INT32);
+    AddPointField(&msg->fields, "intensity", 12, sensor_msgs::PointField::UINT8);
+    msg->point_step = 13;
+
+    /* LivoxRawPoint is packed and already has this layout */
+    msg->data.resize(num * msg->point_step);
+    if (num) {
+      memcpy(&msg->data[0], points, num * msg->point_step);
+    }
+  } else {
+    AddPointField(&msg->fields, "x", 0, sensor_msgs::PointField::INT16);
+    AddPointField(&msg->fields, "y", 2, sensor_msgs::PointField::INT16);
+    AddPointField(&msg->fields, "z", 4, sensor_msgs::PointField::INT16);
+    AddPointField(&msg->fields, "intensity", 6, sensor_msgs::PointField::UINT8);
+    msg->point_step = 7;
+
+    msg->data.resize(num * msg->point_step);
+    uint8_t *out = num ? &msg->data[0] : NULL;
+    for (uint32_t i = 0; i < num; ++i) {
+      int32_t x = points[i].x;
+      int32_t y = points[i].y;
+      int32_t z = points[i].z;
+      if ((x < -327670) || (x > 327670) || (y < -327670) || (y > 327670) || \
+          (z < -327670) || (z > 327670)) {
+        ++dropped;
+        continue;
+      }
+
+      int16_t xyz[3] = {RoundMmToCm(x), RoundMmToCm(y), RoundMmToCm(z)};
+      memcpy(out, xyz, sizeof(xyz));
+      out[6] = points[i].reflectivity;
+      out += msg->point_step;
+    }
+    msg->data.resize(msg->data.size() - dropped * msg->point_step);
+  }
+
+  msg->width = num - dropped;
+  msg->row_step = msg->width * msg->point_step;
+
+  return dropped;
+}
@@ -0,0 +1,649 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include <vector>
+
+#include "livox_driver_core/driver_core.h"
+#include "livox_driver_core/reconnect.h"
+#include "livox_driver_core/startup.h"
+#include "livox_driver_core/hub_topology.h"
+#include "livox_driver_core/clock_sync.h"
+#include "livox_driver_core/outlier_filter.h"
+#include "livox_driver_core/publisher_qos.h"
+#include "livox_driver_core/ClockSync.h"
+#include "livox_driver_core/OutlierStats.h"
+#include "livox_driver_core/FrameMeta.h"
+
+PointCloudQueue point_cloud_queue_pool[kMaxLidarCount];
+DeviceItem lidars[kMaxLidarCount];
+
+ros::Publisher cloud_pub;
+
+/* for frame metadata use, counters of the previous frame of each handle */
+uint32_t cloud_seq;
+static uint32_t frame_seqs[kMaxLidarCount];
+static uint32_t meta_dropped_points[kMaxLidarCount];
+static uint32_t meta_lost_packets[kMaxLidarCount];
+ros::Publisher meta_pub;
+
+/* for frame stamping use, one sensor clock estimate per lidar */
+static ClockSync clock_syncs[kMaxLidarCount];
+static ros::Publisher clock_pub;
+
+/* for intensity calibration use, the table of each handle follows its broadcast code */
+static std::string intensity_lut_dir;
+static IntensityLut intensity_luts[kMaxLidarCount];
+static bool intensity_lut_loaded[kMaxLidarCount];
+static char intensity_lut_codes[kMaxLidarCount][kBroadcastCodeSize];
+
+/* for outlier filter use, frames are filtered one at a time on the ros thread */
+bool outlier_filter_enable = false;
+static OutlierFilter outlier_filter;
+static std::vector<uint8_t> outlier_keep;
+static uint64_t outlier_rejected_total[kMaxLidarCount];
+static ros::Publisher outlier_pub;
+
+uint8_t hub_handle_table[HUB_SLOT_NUM * HUB_ID_NUM];
+
+/* hub packets of slot and id not in hub_handle_table, resolved by the sdk or dropped */
+static volatile uint32_t hub_table_miss_packets = 0;
+static volatile uint32_t hub_unknown_packets = 0;
+static uint32_t reported_unknown_packets = 0;
+
+#define POINT_LAYOUT_DEFAULT            "xyzi"
+
+#define OUTLIER_RADIUS_DEFAULT          (0.2)     // m
+#define OUTLIER_MIN_NEIGHBORS_DEFAULT   (2)
+#define OUTLIER_REFERENCE_RANGE_DEFAULT (10.0)    // m
+
+typedef void (*PointLayoutSelectFunc)(ros::NodeHandle &node, ros::NodeHandle &private_node,
+                                      const std::string &topic);
+
+/* poll loop of the layout chosen at init, the layout is never checked per point */
+static void (*poll_pointcloud_data)(void) = PollLayoutPointcloudData<PointLayoutXYZI>;
+
+template <typename Layout>
+static void PointLayoutSelect(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  cloud_pub = node.advertise<LayoutCloud<typename Layout::Point> >(topic, PublisherQosQueueSize());
+  for (uint32_t i = 0; i < output_stream_count; i++) {
+    output_streams[i].point_times = Layout::kPointTimes;
+    output_streams[i].pub = node.advertise<LayoutCloud<typename Layout::Point> >(output_streams[i].topic,
+                                                                                PublisherQosQueueSize());
+  }
+  OutputsInit<typename Layout::Point>(node, private_node, topic);
+  poll_pointcloud_data = PollLayoutPointcloudData<Layout>;
+}
+
+static const struct {
+  const char *name;
+  PointLayoutSelectFunc select;
+} point_layouts[] = {
+  { "xyz",   PointLayoutSelect<PointLayoutXYZ> },
+  { "xyzi",  PointLayoutSelect<PointLayoutXYZI> },
+  { "xyzit", PointLayoutSelect<PointLayoutXYZIT> },
+  { "xyzr",  PointLayoutSelect<PointLayoutXYZR> },
+  { "xyzil", PointLayoutSelect<PointLayoutXYZIL> },
+};
+
+/* buffers retired by PointCloudQueueRetire(), the sdk thread may still be writing them */
+typedef struct {
+  LivoxRawPoint *buffer;
+  uint64_t retire_ns;
+} RetiredBuffer;
+
+#define QUEUE_RECLAIM_DELAY_NS          (1000000000ull) // 1s
+
+static uint32_t queue_buffer_points = 0;
+static std::vector<RetiredBuffer> retired_buffers;
+
+bool PointCloudPoolInit(uint32_t buffer_points, bool allocate) {
+  if ((buffer_points == 0) || (buffer_points & (buffer_points - 1))) {
+    ROS_FATAL("Point buffer size %u is not 2^n", buffer_points);
+    return false;
+  }
+
+  queue_buffer_points = buffer_points;
+  for (int i=0; i<kMaxLidarCount; i++) {
+    point_cloud_queue_pool[i].buffer = allocate ? new LivoxRawPoint[buffer_points] : NULL;
+    point_cloud_queue_pool[i].rd_idx = 0;
+    point_cloud_queue_pool[i].wr_idx = 0;
+    point_cloud_queue_pool[i].size = buffer_points;
+    point_cloud_queue_pool[i].mask = buffer_points - 1;
+  }
+
+  return true;
+}
+
+void PointCloudPoolUninit(void) {
+  for (int i=0; i<kMaxLidarCount; i++) {
+    delete [] point_cloud_queue_pool[i].buffer;
+    point_cloud_queue_pool[i].buffer = NULL;
+  }
+  for (size_t i = 0; i < retired_buffers.size(); i++) {
+    delete [] retired_buffers[i].buffer;
+  }
+  retired_buffers.clear();
+}
+
+bool PointCloudQueueAlloc(uint8_t handle) {
+  PointCloudQueue *queue = &point_cloud_queue_pool[handle];
+  if (queue->buffer) {
+    return true;
+  }
+
+  /* a sdk thread still inside the retired buffer may push, skip whatever it does */
+  LivoxRawPoint *buffer = new LivoxRawPoint[queue_buffer_points];
+  __atomic_store_n(&queue->buffer, buffer, __ATOMIC_RELEASE);
+  PointCloudQueueFlush(handle);
+  return true;
+}
+
+void PointCloudQueueRetire(uint8_t handle) {
+  PointCloudQueue *queue = &point_cloud_queue_pool[handle];
+  if (!queue->buffer) {
+    return;
+  }
+
+  RetiredBuffer retired;
+  retired.buffer = queue->buffer;
+  retired.retire_ns = MonotonicNs();
+  __atomic_store_n(&queue->buffer, (LivoxRawPoint *)NULL, __ATOMIC_RELEASE);
+  retired_buffers.push_back(retired);
+}
+
+void PointCloudQueueReclaim(void) {
+  uint64_t now = MonotonicNs();
+  while (!retired_buffers.empty() && (now - retired_buffers.front().retire_ns > QUEUE_RECLAIM_DELAY_NS)) {
+    delete [] retired_buffers.front().buffer;
+    retired_buffers.erase(retired_buffers.begin());
+  }
+}
+
+void PointCloudQueueFlush(uint8_t handle) {
+  PointCloudQueue *queue = &point_cloud_queue_pool[handle];
+  uint32_t stamp_wr = __atomic_load_n(&queue->stamp_wr, __ATOMIC_ACQUIRE);
+  queue->rd_idx = queue->wr_idx;
+  queue->stamp_rd = stamp_wr;
+  queue->stamp_fed = stamp_wr;
+  __atomic_store_n(&queue->dropped_points, 0, __ATOMIC_RELAXED);
+  ClockSyncReset(&clock_syncs[handle]);
+}
+
+static void PublishClockSync(uint8_t handle, const ClockSync *sync, const ros::Time &stamp) {
+  livox_driver_core::ClockSyncPtr msg(new livox_driver_core::ClockSync);
+  msg->header.stamp = stamp;
+  msg->header.frame_id = "livox_frame";
+  msg->handle = handle;
+  msg->offset = (sync->base_delay + sync->offset + sync->drift * sync->bucket_sensor[(sync->bucket_count - 1) % CLOCK_SYNC_BUCKETS]) / 1e9;
+  msg->drift_ppm = sync->drift * 1e6;
+  msg->fit_rms = sync->fit_rms / 1e9;
+  msg->residual_mean = sync->last_residual_mean / 1e9;
+  msg->residual_max = sync->last_residual_max / 1e9;
+  msg->samples = sync->last_samples;
+  msg->resets = sync->resets;
+  clock_pub.publish(msg);
+}
+
+/* packet of point_idx, the last one starting at or before it, NULL if none arrived yet */
+static const PacketStamp *QueueFindStamp(PointCloudQueue *queue, uint32_t point_idx, uint32_t *stamp_rd,
+                                         uint32_t stamp_wr) {
+  if ((int32_t)(stamp_wr - *stamp_rd) > PACKET_STAMP_NUM) {
+    *stamp_rd = stamp_wr - PACKET_STAMP_NUM;
+  }
+  while ((*stamp_rd + 1 != stamp_wr) && (*stamp_rd != stamp_wr)) {
+    const PacketStamp *next = &queue->stamps[(*stamp_rd + 1) & (PACKET_STAMP_NUM - 1)];
+    if ((int32_t)(next->point_idx - point_idx) > 0) {
+      break;
+    }
+    (*stamp_rd)++;
+  }
+  return (*stamp_rd == stamp_wr) ? NULL : &queue->stamps[*stamp_rd & (PACKET_STAMP_NUM - 1)];
+}
+
+/* ros time of point_idx from the sensor clock of its packet, or the packet arrival */
+static uint64_t StampRosNs(const ClockSync *sync, const PacketStamp *stamp, uint32_t point_idx) {
+  uint64_t ros_ns;
+  uint64_t point_offset = (uint64_t)(point_idx - stamp->point_idx) * POINT_INTERVAL_NS;
+  if (!stamp->sensor_ns || !ClockSyncMap(sync, stamp->sensor_ns + point_offset, &ros_ns)) {
+    ros_ns = stamp->arrival_ns;
+  }
+  return ros_ns;
+}
+
+const PacketStamp *QueuePointPacket(PointCloudQueue *queue, uint32_t point_idx, uint32_t *stamp_rd) {
+  return QueueFindStamp(queue, point_idx, stamp_rd, __atomic_load_n(&queue->stamp_wr, __ATOMIC_ACQUIRE));
+}
+
+ros::Time QueuePointStamp(uint8_t handle, PointCloudQueue *queue, uint32_t point_idx, uint32_t *stamp_rd) {
+  uint32_t stamp_wr = __atomic_load_n(&queue->stamp_wr, __ATOMIC_ACQUIRE);
+  const PacketStamp *stamp = QueueFindStamp(queue, point_idx, stamp_rd, stamp_wr);
+  return stamp ? ros::Time().fromNSec(StampRosNs(&clock_syncs[handle], stamp, point_idx)) : ros::Time::now();
+}
+
+ros::Time QueueFrameStamp(uint8_t handle, PointCloudQueue *queue, uint32_t num, FrameTiming *timing) {
+  ClockSync *sync = &clock_syncs[handle];
+  uint32_t rd_idx = queue->rd_idx;
+  uint32_t stamp_wr = __atomic_load_n(&queue->stamp_wr, __ATOMIC_ACQUIRE);
+  const PacketStamp *last = NULL;
+
+  /* feed the packets of this frame to the estimator, each once */
+  if ((int32_t)(stamp_wr - queue->stamp_fed) > PACKET_STAMP_NUM) {
+    queue->stamp_fed = stamp_wr - PACKET_STAMP_NUM;
+  }
+  while (queue->stamp_fed != stamp_wr) {
+    const PacketStamp *stamp = &queue->stamps[queue->stamp_fed & (PACKET_STAMP_NUM - 1)];
+    if ((int32_t)(stamp->point_idx - (rd_idx + num)) >= 0) {
+      break;
+    }
+    if (stamp->sensor_ns && ClockSyncAdd(sync, stamp->sensor_ns, stamp->arrival_ns)) {
+      PublishClockSync(handle, sync, ros::Time().fromNSec(stamp->arrival_ns));
+    }
+    last = stamp;
+    queue->stamp_fed++;
+  }
+
+  /* packet of the first point */
+  const PacketStamp *stamp = QueueFindStamp(queue, rd_idx, &queue->stamp_rd, stamp_wr);
+  if (!stamp) {
+    memset(timing, 0, sizeof(*timing));
+    return ros::Time::now();
+  }
+
+  uint64_t point_offset = (uint64_t)(rd_idx - stamp->point_idx) * POINT_INTERVAL_NS;
+
+  /* the last point is in the last packet fed above, or in the first packet if none was */
+  last = last ? last : stamp;
+  timing->first_sensor_ns = stamp->sensor_ns ? stamp->sensor_ns + point_offset : 0;
+  timing->last_sensor_ns = last->sensor_ns ?
+                           last->sensor_ns + (uint64_t)(rd_idx + num - 1 - last->point_idx) * POINT_INTERVAL_NS : 0;
+  timing->first_arrival_ns = stamp->arrival_ns;
+  return ros::Time().fromNSec(StampRosNs(sync, stamp, rd_idx));
+}
+
+const FrameTimes *QueueFrameTimes(PointCloudQueue *queue, uint32_t num) {
+  static std::vector<PacketOffset> packets;
+  static FrameTimes times;
+  uint32_t rd_idx = queue->rd_idx;
+  uint32_t stamp_wr = __atomic_load_n(&queue->stamp_wr, __ATOMIC_ACQUIRE);
+  uint32_t interval_ns = 0;
+  PacketOffset first = {0, 0};
+
+  packets.assign(1, first);
+  times.point_interval_ns = POINT_INTERVAL_NS;
+
+  /* QueueFrameStamp left stamp_rd on the packet of the first point */
+  uint32_t idx = queue->stamp_rd;
+  if ((idx == stamp_wr) || ((int32_t)(stamp_wr - idx) > PACKET_STAMP_NUM)) {
+    times.packets = &packets[0];
+    times.count = 1;
+    return &times;
+  }
+  const PacketStamp *prev = &queue->stamps[idx & (PACKET_STAMP_NUM - 1)];
+  uint64_t first_ns = prev->sensor_ns;
+  bool valid = (prev->sensor_ns != 0);
+  if (valid) {
+    first_ns += (uint64_t)(rd_idx - prev->point_idx) * POINT_INTERVAL_NS;
+  }
+
+  for (idx++; valid && (idx != stamp_wr); idx++) {
+    const PacketStamp *stamp = &queue->stamps[idx & (PACKET_STAMP_NUM - 1)];
+    uint32_t point = stamp->point_idx - rd_idx;
+    if (point >= num) {
+      break;
+    }
+    if (!stamp->sensor_ns || (stamp->sensor_ns < first_ns) || (stamp->sensor_ns - first_ns > 0xFFFFFFFFull) ||
+        (stamp->sensor_ns <= prev->sensor_ns)) {
+      valid = false;
+      break;
+    }
+
+    /* a lost packet only widens a pair, the closest pair is the sampling rate */
+    uint32_t pair_points = stamp->point_idx - prev->point_idx;
+    if (pair_points) {
+      uint32_t pair_ns = (uint32_t)((stamp->sensor_ns - prev->sensor_ns) / pair_points);
+      if (!interval_ns || (pair_ns < interval_ns)) {
+        interval_ns = pair_ns;
+      }
+    }
+    PacketOffset packet = {point, (uint32_t)(stamp->sensor_ns - first_ns)};
+    packets.push_back(packet);
+    prev = stamp;
+  }
+
+  /* no sensor time, or it went back: evenly spaced from the first point */
+  if (!valid) {
+    packets.resize(1);
+  } else if (interval_ns) {
+    times.point_interval_ns = interval_ns;
+  }
+  times.packets = &packets[0];
+  times.count = packets.size();
+  return &times;
+}
+
+void HubHandleTableUpdate(const DeviceInfo *devices, uint8_t count) {
+  uint8_t table[HUB_SLOT_NUM * HUB_ID_NUM];
+  memset(table, 0, sizeof(table));
+
+  for (int i = 0; i < count; ++i) {
+    const DeviceInfo *device = &devices[i];
+    if ((device->type == kDeviceTypeHub) || (device->handle >= kMaxLidarCount)) {
+      continue;
+    }
+    if ((device->slot >= HUB_SLOT_NUM) || (device->id >= HUB_ID_NUM)) {
+      ROS_WARN("lidar %d : %s slot %d id %d out of range", device->handle, device->broadcast_code,
+               device->slot, device->id);
+      continue;
+    }
+    table[device->slot * HUB_ID_NUM + device->id] = device->handle + 1;
+  }
+
+  /* single byte entries, the data callback never sees a torn one */
+  for (size_t i = 0; i < sizeof(table); ++i) {
+    __atomic_store_n(&hub_handle_table[i], table[i], __ATOMIC_RELAXED);
+  }
+}
+
+uint8_t HubHandleTableMiss(uint8_t slot, uint8_t id) {
+  uint8_t handle = HubGetLidarHandle(slot, id);
+  if (handle >= kMaxLidarCount) {
+    __atomic_add_fetch(&hub_unknown_packets, 1, __ATOMIC_RELAXED);
+    return kMaxLidarCount;
+  }
+
+  __atomic_add_fetch(&hub_table_miss_packets, 1, __ATOMIC_RELAXED);
+  if ((slot < HUB_SLOT_NUM) && (id < HUB_ID_NUM)) {
+    __atomic_store_n(&hub_handle_table[slot * HUB_ID_NUM + id], handle + 1, __ATOMIC_RELAXED);
+  }
+  return handle;
+}
+
+/* increase of a counter since the last call, counters restart when a hub lidar is replaced */
+static uint32_t CounterDelta(uint32_t current, uint32_t *last) {
+  uint32_t delta = (current >= *last) ? current - *last : current;
+  *last = current;
+  return delta;
+}
+
+void PublishFrameMeta(uint8_t handle, const std_msgs::Header &header, const FrameTiming &timing,
+                      uint32_t num, uint32_t published) {
+  const DeviceItem *lidar = &lidars[handle];
+  uint32_t dropped = __atomic_load_n(&point_cloud_queue_pool[handle].dropped_points, __ATOMIC_RELAXED);
+  uint32_t lost = __atomic_load_n(&lidar->statistic_info.loss_packet_count, __ATOMIC_RELAXED);
+
+  livox_driver_core::FrameMetaPtr msg(new livox_driver_core::FrameMeta);
+  msg->header = header;
+  msg->handle = handle;
+  msg->broadcast_code = std::string(lidar->info.broadcast_code, strnlen(lidar->info.broadcast_code, kBroadcastCodeSize));
+  msg->seq = ++frame_seqs[handle];
+  msg->timestamp_type = lidar->statistic_info.last_timestamp_type;
+  msg->first_sensor_ns = timing.first_sensor_ns;
+  msg->last_sensor_ns = timing.last_sensor_ns;
+  msg->point_count = published;
+  msg->dropped_points = CounterDelta(dropped, &meta_dropped_points[handle]);
+  msg->lost_packets = CounterDelta(lost, &meta_lost_packets[handle]);
+  msg->filtered_points = num - published;
+  msg->assembly_latency = timing.first_arrival_ns ?
+                          (ros::Time::now().toNSec() - timing.first_arrival_ns) / 1e9 : 0.0;
+  meta_pub.publish(msg);
+}
+
+const IntensityLut *IntensityLutOfHandle(uint8_t handle) {
+  if (intensity_lut_dir.empty()) {
+    return NULL;
+  }
+
+  const char *code = lidars[handle].info.broadcast_code;
+  if (strncmp(code, intensity_lut_codes[handle], kBroadcastCodeSize)) {
+    strncpy(intensity_lut_codes[handle], code, kBroadcastCodeSize - 1);
+    intensity_lut_codes[handle][kBroadcastCodeSize - 1] = '\0';
+
+    std::string path = intensity_lut_dir + "/" + intensity_lut_codes[handle] + ".lut";
+    intensity_lut_loaded[handle] = code[0] && (IntensityLutLoad(&intensity_luts[handle], path.c_str()) == 0);
+    if (intensity_lut_loaded[handle]) {
+      ROS_INFO("lidar %d : intensity lut %s, %u range bins", handle, path.c_str(),
+               intensity_luts[handle].range_bins);
+    } else if (code[0]) {
+      ROS_INFO("lidar %d : no intensity lut %s, raw reflectivity", handle, path.c_str());
+    }
+  }
+
+  return intensity_lut_loaded[handle] ? &intensity_luts[handle] : NULL;
+}
+
+uint32_t FrameOutlierFilter(uint8_t handle, LivoxRawPoint *raw_points, void *points, uint32_t point_step,
+                            uint32_t num) {
+  outlier_keep.resize(num);
+  uint32_t rejected = num ? OutlierFilterClassify(&outlier_filter, raw_points, num, &outlier_keep[0]) : 0;
+
+  if (rejected) {
+    uint8_t *bytes = (uint8_t *)points;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < num; ++i) {
+      if (!outlier_keep[i]) {
+        continue;
+      }
+      if (kept != i) {
+        raw_points[kept] = raw_points[i];
+        if (bytes) {
+          memcpy(bytes + kept * point_step, bytes + i * point_step, point_step);
+        }
+      }
+      kept++;
+    }
+  }
+
+  outlier_rejected_total[handle] += rejected;
+  livox_driver_core::OutlierStatsPtr msg(new livox_driver_core::OutlierStats);
+  msg->header.stamp = ros::Time::now();
+  msg->header.frame_id = "livox_frame";
+  msg->handle = handle;
+  msg->points = num;
+  msg->rejected = rejected;
+  msg->rejected_total = outlier_rejected_total[handle];
+  outlier_pub.publish(msg);
+
+  return num - rejected;
+}
+
+static void OutlierOutputInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  private_node.param("outlier_filter_enable", outlier_filter_enable, false);
+  if (!outlier_filter_enable) {
+    return;
+  }
+
+  double radius, reference_range;
+  int min_neighbors;
+  private_node.param("outlier_radius", radius, OUTLIER_RADIUS_DEFAULT);
+  private_node.param("outlier_min_neighbors", min_neighbors, OUTLIER_MIN_NEIGHBORS_DEFAULT);
+  private_node.param("outlier_reference_range", reference_range, OUTLIER_REFERENCE_RANGE_DEFAULT);
+  if ((radius <= 0) || (min_neighbors <= 0) || (reference_range <= 0)) {
+    ROS_WARN("Invalid outlier filter config, outlier filter disabled");
+    outlier_filter_enable = false;
+    return;
+  }
+
+  OutlierFilterConfig config;
+  config.radius = radius;
+  config.min_neighbors = min_neighbors;
+  config.reference_range = reference_range;
+  OutlierFilterInit(&outlier_filter, config);
+
+  ROS_INFO("Outlier filter %d neighbors within %.2fm up to %.1fm", min_neighbors, radius, reference_range);
+  outlier_pub = node.advertise<livox_driver_core::OutlierStats>(topic + "_outliers", kMaxLidarCount);
+}
+
+static void ReportHubUnknownPackets(void) {
+  uint32_t unknown = __atomic_load_n(&hub_unknown_packets, __ATOMIC_RELAXED);
+  if (unknown != reported_unknown_packets) {
+    ROS_WARN_THROTTLE(1.0, "%u hub packets of unknown slot/id dropped, %u resolved outside the table",
+                      unknown, __atomic_load_n(&hub_table_miss_packets, __ATOMIC_RELAXED));
+    reported_unknown_packets = unknown;
+  }
+}
+
+bool PointCloudPublishInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  std::string layout;
+  private_node.param("point_layout", layout, std::string(POINT_LAYOUT_DEFAULT));
+  PublisherQosInit(node, private_node, topic);
+  clock_pub = node.advertise<livox_driver_core::ClockSync>(topic + "_clock", kMaxLidarCount);
+  meta_pub = node.advertise<livox_driver_core::FrameMeta>(topic + "_meta", PublisherQosQueueSize());
+  OutlierOutputInit(node, private_node, topic);
+  OutputStreamsInit(private_node, topic);
+  private_node.param("intensity_lut_dir", intensity_lut_dir, std::string(""));
+
+  for (size_t i = 0; i < sizeof(point_layouts) / sizeof(point_layouts[0]); i++) {
+    if (layout == point_layouts[i].name) {
+      ROS_INFO("Point layout %s", point_layouts[i].name);
+      point_layouts[i].select(node, private_node, topic);
+      return true;
+    }
+  }
+
+  ROS_FATAL("Unknown point layout %s", layout.c_str());
+  return false;
+}
+
+void PollPointcloudData(void) {
+  ReconnectPoll();
+  StartupPoll();
+  HubTopologyPoll();
+  ReportHubUnknownPackets();
+  poll_pointcloud_data();
+}
+
+/* learn the packet interval of handle, count the packets missing in a gap */
+static void PacketGapUpdate(uint8_t handle, LidarPacketStatistic *packet_statistic, int64_t packet_gap) {
+  if (packet_gap <= 0) {
+    return;
+  }
+
+  double gap = (double)packet_gap;
+  if (packet_statistic->interval_samples >= PACKET_GAP_WARMUP) {
+    double mean = packet_statistic->interval_mean;
+    double threshold = mean + PACKET_GAP_SIGMA * sqrt(packet_statistic->interval_var);
+    if (threshold < mean * PACKET_GAP_MIN_RATIO) {
+      threshold = mean * PACKET_GAP_MIN_RATIO;
+    }
+
+    /* the interval itself changed, e.g. another lidar or mode at the handle */
+    if ((gap > threshold) && (++packet_statistic->interval_gaps >= PACKET_GAP_RELEARN)) {
+      ROS_INFO("%d packet interval %.0f no longer matches, relearn", handle, mean);
+      packet_statistic->interval_samples = 0;
+      packet_statistic->interval_gaps = 0;
+    } else if (gap > threshold) {
+      double packets = gap / mean + 0.5;
+      uint32_t missing = (packets < PACKET_GAP_MISSING_MAX) ? (uint32_t)packets - 1 : PACKET_GAP_MISSING_MAX;
+      if (!missing) {
+        missing = 1;
+      }
+      packet_statistic->loss_packet_count += missing;
+      ROS_INFO_THROTTLE(1.0, "%d miss count : gap %" PRId64 " interval %.0f missing %u total %u", \
+               handle, packet_gap, mean, missing, packet_statistic->loss_packet_count);
+      return;
+    } else {
+      packet_statistic->interval_gaps = 0;
+    }
+  }
+
+  /* first samples average evenly, then ewma */
+  packet_statistic->interval_samples++;
+  double alpha = (packet_statistic->interval_samples < (1 << PACKET_GAP_EWMA_SHIFT)) ?
+                 1.0 / packet_statistic->interval_samples : 1.0 / (1 << PACKET_GAP_EWMA_SHIFT);
+  double delta = gap - packet_statistic->interval_mean;
+  packet_statistic->interval_mean += alpha * delta;
+  packet_statistic->interval_var = (1 - alpha) * (packet_statistic->interval_var + alpha * delta * delta);
+}
+
+void ProcessLidarData(uint8_t handle, LivoxEthPacket *data, uint32_t data_num) {
+  LivoxEthPacket *lidar_pack = data;
+  uint64_t sensor_ns = 0;
+
+  LidarPacketStatistic *packet_statistic = &lidars[handle].statistic_info;
+  if (__atomic_load_n(&lidars[handle].statistic_reset, __ATOMIC_ACQUIRE)) {
+    memset(packet_statistic, 0, sizeof(*packet_statistic));
+    __atomic_store_n(&lidars[handle].statistic_reset, 0, __ATOMIC_RELEASE);
+  }
+  packet_statistic->receive_packet_count++;
+
+  uint64_t cur_timestamp;
+  if (PacketTimeDecode(lidar_pack, &cur_timestamp)) {
+    /* times of different types do not compare */
+    if (lidar_pack->timestamp_type != packet_statistic->last_timestamp_type) {
+      ROS_INFO("%d timestamp type %s", handle, PacketTimeTypeName(lidar_pack->timestamp_type));
+      packet_statistic->last_timestamp_type = lidar_pack->timestamp_type;
+      packet_statistic->last_timestamp = 0;
+      packet_statistic->interval_samples = 0;
+      packet_statistic->interval_gaps = 0;
+    }
+
+    if (packet_statistic->last_timestamp) {
+      PacketGapUpdate(handle, packet_statistic, (int64_t)(cur_timestamp - packet_statistic->last_timestamp));
+    }
+
+    packet_statistic->last_timestamp = cur_timestamp;
+    sensor_ns = cur_timestamp;
+  }
+
+  LivoxRawPoint *p_point_data = (LivoxRawPoint *)lidar_pack->data;
+  PointCloudQueue *p_queue    = &point_cloud_queue_pool[handle];
+
+  /* loaded once, the queue of a lidar that left the hub may be retired meanwhile */
+  LivoxRawPoint *buffer = __atomic_load_n(&p_queue->buffer, __ATOMIC_ACQUIRE);
+  if (buffer) {
+    uint32_t stamp_wr = p_queue->stamp_wr;
+    PacketStamp *stamp = &p_queue->stamps[stamp_wr & (PACKET_STAMP_NUM - 1)];
+    stamp->point_idx = p_queue->wr_idx;
+    stamp->sensor_ns = sensor_ns;
+    stamp->arrival_ns = ros::Time::now().toNSec();
+    __atomic_store_n(&p_queue->stamp_wr, stamp_wr + 1, __ATOMIC_RELEASE);
+
+    uint32_t pushed = QueuePushBatch(p_queue, buffer, p_point_data, data_num);
+    if (pushed < data_num) {
+      __atomic_add_fetch(&p_queue->dropped_points, data_num - pushed, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+void OnDeviceInformation(uint8_t status, uint8_t handle, DeviceInformationResponse *ack, void *data) {
+  if (status != kStatusSuccess) {
+    ROS_INFO("Device Query Informations Failed %d", status);
+  } else {
+    StartupStamp(handle, kStartupInfo);
+  }
+  if (ack) {
+    ROS_INFO("firm ver: %d.%d.%d.%d",
+             ack->firmware_version[0],
+             ack->firmware_version[1],
+             ack->firmware_version[2],
+             ack->firmware_version[3]);
+  }
+}
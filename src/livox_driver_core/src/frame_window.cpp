@@ -0,0 +1,93 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "livox_driver_core/frame_window.h"
+
+void FrameWindowInit(FrameWindow *window, double span_sec, uint32_t max_segments, uint32_t point_step,
+                     const std::vector<sensor_msgs::PointField> *fields) {
+  uint32_t segments = WINDOW_SEGMENTS_MIN;
+  while ((segments < max_segments) && (segments < WINDOW_SEGMENTS_MAX)) {
+    segments <<= 1;
+  }
+
+  window->segments.assign(segments, FrameSegment());
+  window->rd_idx = 0;
+  window->wr_idx = 0;
+  window->mask = segments - 1;
+  window->point_count = 0;
+  window->point_step = point_step;
+  window->fields = fields;
+  window->span = ros::Duration(span_sec);
+}
+
+static void FrameWindowPop(FrameWindow *window) {
+  FrameSegment *segment = &window->segments[window->rd_idx & window->mask];
+
+  window->point_count -= segment->point_count;
+  segment->owner.reset();
+  window->rd_idx++;
+}
+
+void FrameWindowPush(FrameWindow *window, const FrameSegment &segment) {
+  if (!segment.point_count) {
+    return;
+  }
+
+  /* ring too short for the frame rate, drop the oldest segment */
+  if ((window->wr_idx - window->rd_idx) > window->mask) {
+    const FrameSegment *oldest = &window->segments[window->rd_idx & window->mask];
+    ROS_WARN_THROTTLE(1.0, "Accumulate window full at %u frames, dropped one %.3fs before its time",
+                      window->mask + 1, (window->span - (segment.stamp - oldest->stamp)).toSec());
+    FrameWindowPop(window);
+  }
+
+  window->segments[window->wr_idx & window->mask] = segment;
+  window->point_count += segment.point_count;
+  window->wr_idx++;
+}
+
+void FrameWindowAgeOut(FrameWindow *window, const ros::Time &now) {
+  while (window->rd_idx != window->wr_idx) {
+    FrameSegment *segment = &window->segments[window->rd_idx & window->mask];
+    if ((now - segment->stamp) <= window->span) {
+      break;
+    }
+    FrameWindowPop(window);
+  }
+}
+
+AccumulatedCloudPtr FrameWindowSnapshot(const FrameWindow *window) {
+  AccumulatedCloudPtr accumulated(new AccumulatedCloud);
+  accumulated->fields = window->fields;
+  accumulated->point_step = window->point_step;
+  accumulated->width = window->point_count;
+  accumulated->deduplicated = false;
+  accumulated->segments.reserve(window->wr_idx - window->rd_idx);
+
+  for (uint32_t i = window->rd_idx; i != window->wr_idx; ++i) {
+    accumulated->segments.push_back(window->segments[i & window->mask]);
+  }
+
+  return accumulated;
+}
@@ -0,0 +1,95 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+
+#include "livox_driver_core/ground_segment.h"
+
+void GroundSegmentInit(GroundSegment *segment, const GroundSegmentConfig &config) {
+  segment->config = config;
+  segment->cols = (uint32_t)ceilf(2.0f * config.range / config.cell_size);
+  segment->min_z.assign(segment->cols * segment->cols, 0.0f);
+  segment->cell_frame.assign(segment->cols * segment->cols, 0);
+  segment->frame = 0;
+}
+
+uint32_t GroundSegmentClassify(GroundSegment *segment, const LivoxRawPoint *points, uint32_t num,
+                               uint8_t *is_ground) {
+  const GroundSegmentConfig &config = segment->config;
+
+  segment->cell.resize(num);
+  segment->z.resize(num);
+  if (!num) {
+    return 0;
+  }
+
+  /* 0 marks cells never written */
+  if (++segment->frame == 0) {
+    segment->cell_frame.assign(segment->cell_frame.size(), 0);
+    segment->frame = 1;
+  }
+
+  int32_t *cell = &segment->cell[0];
+  float *z = &segment->z[0];
+  float *min_z = &segment->min_z[0];
+  uint32_t *cell_frame = &segment->cell_frame[0];
+  uint32_t frame = segment->frame;
+  float scale = 1.0f / (config.cell_size * 1000.0f);      // raw points are in mm
+  float offset = config.range / config.cell_size;
+  float cols = (float)segment->cols;
+  int32_t stride = (int32_t)segment->cols;
+
+  /* lowest point of every cell */
+  for (uint32_t i = 0; i < num; ++i) {
+    float col = points[i].x * scale + offset;
+    float row = points[i].y * scale + offset;
+    z[i] = points[i].z / 1000.0f;
+    if (!((col >= 0.0f) && (col < cols) && (row >= 0.0f) && (row < cols)) ||
+        (!points[i].x && !points[i].y && !points[i].z)) {
+      cell[i] = -1;
+      continue;
+    }
+
+    int32_t c = (int32_t)row * stride + (int32_t)col;
+    cell[i] = c;
+    if ((cell_frame[c] != frame) || (z[i] < min_z[c])) {
+      cell_frame[c] = frame;
+      min_z[c] = z[i];
+    }
+  }
+
+  /* cells whose lowest point fits the height prior are ground */
+  float ground_min = -config.sensor_height - config.height_tolerance;
+  float ground_max = -config.sensor_height + config.height_tolerance;
+  uint32_t ground_count = 0;
+  for (uint32_t i = 0; i < num; ++i) {
+    int32_t c = cell[i];
+    uint8_t ground = (c >= 0) && (min_z[c] >= ground_min) && (min_z[c] <= ground_max) &&
+                     (z[i] - min_z[c] <= config.thickness);
+    is_ground[i] = ground;
+    ground_count += ground;
+  }
+
+  return ground_count;
+}
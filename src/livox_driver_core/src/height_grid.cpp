@@ -0,0 +1,182 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+#include <string.h>
+
+#include <sensor_msgs/image_encodings.h>
+
+#include "livox_driver_core/height_grid.h"
+
+/* storage index of a cell index of the grid frame, size need not be 2^n */
+static inline uint32_t WrapIndex(int32_t index, uint32_t size) {
+  int32_t wrapped = index % (int32_t)size;
+  return (wrapped < 0) ? wrapped + size : wrapped;
+}
+
+static void ClearColumn(HeightGrid *grid, uint32_t column) {
+  for (uint32_t row = 0; row < grid->size; ++row) {
+    grid->cells[row * grid->size + column].hits = 0;
+  }
+}
+
+static void ClearRow(HeightGrid *grid, uint32_t row) {
+  for (uint32_t column = 0; column < grid->size; ++column) {
+    grid->cells[row * grid->size + column].hits = 0;
+  }
+}
+
+void HeightGridInit(HeightGrid *grid, float resolution, uint32_t size, float obstacle_height, uint32_t decay_ms) {
+  HeightGridCell empty;
+  memset(&empty, 0, sizeof(empty));
+
+  grid->resolution = resolution;
+  grid->size = size;
+  grid->obstacle_height = obstacle_height;
+  grid->decay_ms = decay_ms;
+  grid->origin_x = -(int32_t)(size / 2);
+  grid->origin_y = -(int32_t)(size / 2);
+  grid->cells.assign(size * size, empty);
+}
+
+void HeightGridRecenter(HeightGrid *grid, float x, float y) {
+  int32_t size = (int32_t)grid->size;
+  int32_t origin_x = (int32_t)floorf(x / grid->resolution) - size / 2;
+  int32_t origin_y = (int32_t)floorf(y / grid->resolution) - size / 2;
+  int32_t dx = origin_x - grid->origin_x;
+  int32_t dy = origin_y - grid->origin_y;
+
+  if ((dx >= size) || (dx <= -size) || (dy >= size) || (dy <= -size)) {
+    for (size_t i = 0; i < grid->cells.size(); ++i) {
+      grid->cells[i].hits = 0;
+    }
+  } else {
+    /* columns and rows that leave the window are those entering it on the other side */
+    for (int32_t ix = (dx > 0) ? grid->origin_x : origin_x + size;
+         ix < ((dx > 0) ? origin_x : grid->origin_x + size); ++ix) {
+      ClearColumn(grid, WrapIndex(ix, grid->size));
+    }
+    for (int32_t iy = (dy > 0) ? grid->origin_y : origin_y + size;
+         iy < ((dy > 0) ? origin_y : grid->origin_y + size); ++iy) {
+      ClearRow(grid, WrapIndex(iy, grid->size));
+    }
+  }
+
+  grid->origin_x = origin_x;
+  grid->origin_y = origin_y;
+}
+
+void HeightGridInsert(HeightGrid *grid, const LivoxRawPoint *points, uint32_t num,
+                      const HeightGridTransform &transform, uint32_t now_ms) {
+  const float (*r)[3] = transform.rotation;
+  const float *t = transform.translation;
+  float inv_resolution = 1.0f / grid->resolution;
+
+  for (uint32_t i = 0; i < num; ++i) {
+    if (!points[i].x && !points[i].y && !points[i].z) {
+      continue;
+    }
+
+    float px = points[i].x / 1000.0f;
+    float py = points[i].y / 1000.0f;
+    float pz = points[i].z / 1000.0f;
+    float x = r[0][0] * px + r[0][1] * py + r[0][2] * pz + t[0];
+    float y = r[1][0] * px + r[1][1] * py + r[1][2] * pz + t[1];
+    float z = r[2][0] * px + r[2][1] * py + r[2][2] * pz + t[2];
+
+    int32_t ix = (int32_t)floorf(x * inv_resolution) - grid->origin_x;
+    int32_t iy = (int32_t)floorf(y * inv_resolution) - grid->origin_y;
+    if ((ix < 0) || (ix >= (int32_t)grid->size) || (iy < 0) || (iy >= (int32_t)grid->size)) {
+      continue;
+    }
+
+    HeightGridCell *cell = &grid->cells[WrapIndex(iy + grid->origin_y, grid->size) * grid->size +
+                                        WrapIndex(ix + grid->origin_x, grid->size)];
+    if (!cell->hits || (now_ms - cell->last_ms > grid->decay_ms)) {
+      cell->min_z = z;
+      cell->max_z = z;
+      cell->hits = 0;
+    } else {
+      cell->min_z = (z < cell->min_z) ? z : cell->min_z;
+      cell->max_z = (z > cell->max_z) ? z : cell->max_z;
+    }
+    cell->last_ms = now_ms;
+    if (cell->hits < UINT16_MAX) {
+      cell->hits++;
+    }
+  }
+}
+
+void HeightGridFillOccupancy(const HeightGrid *grid, uint32_t now_ms, nav_msgs::OccupancyGrid *occupancy) {
+  occupancy->info.resolution = grid->resolution;
+  occupancy->info.width = grid->size;
+  occupancy->info.height = grid->size;
+  occupancy->info.origin.position.x = grid->origin_x * grid->resolution;
+  occupancy->info.origin.position.y = grid->origin_y * grid->resolution;
+  occupancy->info.origin.position.z = 0.0;
+  occupancy->info.origin.orientation.x = 0.0;
+  occupancy->info.origin.orientation.y = 0.0;
+  occupancy->info.origin.orientation.z = 0.0;
+  occupancy->info.origin.orientation.w = 1.0;
+  occupancy->data.resize(grid->size * grid->size);
+
+  /* data starts at the window origin, row by row */
+  for (uint32_t y = 0; y < grid->size; ++y) {
+    const HeightGridCell *row = &grid->cells[WrapIndex(grid->origin_y + y, grid->size) * grid->size];
+    int8_t *data = &occupancy->data[y * grid->size];
+    for (uint32_t x = 0; x < grid->size; ++x) {
+      const HeightGridCell *cell = &row[WrapIndex(grid->origin_x + x, grid->size)];
+      if (!cell->hits || (now_ms - cell->last_ms > grid->decay_ms)) {
+        data[x] = -1;
+      } else {
+        data[x] = (cell->max_z - cell->min_z >= grid->obstacle_height) ? 100 : 0;
+      }
+    }
+  }
+}
+
+void HeightGridFillElevation(const HeightGrid *grid, uint32_t now_ms, sensor_msgs::Image *elevation) {
+  elevation->height = grid->size;
+  elevation->width = grid->size;
+  elevation->encoding = sensor_msgs::image_encodings::TYPE_32FC2;
+  elevation->is_bigendian = false;
+  elevation->step = grid->size * 2 * sizeof(float);
+  elevation->data.resize(elevation->step * grid->size);
+
+  /* same order as the occupancy data, row 0 at the window origin */
+  for (uint32_t y = 0; y < grid->size; ++y) {
+    const HeightGridCell *row = &grid->cells[WrapIndex(grid->origin_y + y, grid->size) * grid->size];
+    float *data = (float *)&elevation->data[y * elevation->step];
+    for (uint32_t x = 0; x < grid->size; ++x) {
+      const HeightGridCell *cell = &row[WrapIndex(grid->origin_x + x, grid->size)];
+      if (!cell->hits || (now_ms - cell->last_ms > grid->decay_ms)) {
+        data[2 * x] = NAN;
+        data[2 * x + 1] = NAN;
+      } else {
+        data[2 * x] = cell->min_z;
+        data[2 * x + 1] = cell->max_z;
+      }
+    }
+  }
+}
@@ -0,0 +1,177 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string.h>
+
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include "livox_driver_core/hub_topology.h"
+#include "livox_driver_core/driver_core.h"
+#include "livox_driver_core/outputs.h"
+#include "livox_driver_core/output_stream.h"
+#include "livox_driver_core/startup.h"
+#include "livox_driver_core/HubTopology.h"
+
+typedef struct {
+  bool valid;
+  uint8_t slot;
+  uint8_t id;
+  char broadcast_code[kBroadcastCodeSize];
+  DeviceInfo info;
+} HubTopologyEntry;
+
+static bool topology_enable = false;
+static ros::Publisher topology_pub;
+
+/* lidars known by the ros thread */
+static HubTopologyEntry topology[kMaxLidarCount];
+
+/* last connected devices of the sdk thread */
+static boost::mutex pending_mutex;
+static bool pending = false;
+static HubTopologyEntry pending_topology[kMaxLidarCount];
+
+void HubTopologyInit(ros::NodeHandle &node, const std::string &topic) {
+  topology_enable = true;
+  topology_pub = node.advertise<livox_driver_core::HubTopology>(topic + "_topology", 1, true);
+}
+
+void HubTopologyRefresh(void) {
+  DeviceInfo devices[kMaxLidarCount];
+  uint8_t count = kMaxLidarCount;
+  if (GetConnectedDevices(devices, &count) != kStatusSuccess) {
+    return;
+  }
+
+  HubHandleTableUpdate(devices, count);
+
+  HubTopologyEntry entries[kMaxLidarCount];
+  memset(entries, 0, sizeof(entries));
+  for (int i = 0; i < count; i++) {
+    const DeviceInfo *device = &devices[i];
+    if ((device->type == kDeviceTypeHub) || (device->handle >= kMaxLidarCount)) {
+      continue;
+    }
+    HubTopologyEntry *entry = &entries[device->handle];
+    entry->valid = true;
+    entry->slot = device->slot;
+    entry->id = device->id;
+    strncpy(entry->broadcast_code, device->broadcast_code, kBroadcastCodeSize - 1);
+    entry->info = *device;
+  }
+
+  boost::mutex::scoped_lock lock(pending_mutex);
+  memcpy(pending_topology, entries, sizeof(entries));
+  pending = true;
+}
+
+static bool SameLidar(const HubTopologyEntry *a, const HubTopologyEntry *b) {
+  return (a->slot == b->slot) && (a->id == b->id) &&
+         (strncmp(a->broadcast_code, b->broadcast_code, kBroadcastCodeSize) == 0);
+}
+
+/*
+ * new lidar at handle, no points, stamps, clock fit or output state of a former lidar are left.
+ * The sdk thread may still be in ProcessLidarData for handle, it clears the statistic itself.
+ */
+static void ResetLidar(uint8_t handle, const HubTopologyEntry *entry) {
+  PointCloudQueueFlush(handle);
+  OutputsReleaseHandle(handle);
+  OutputStreamsReleaseHandle(handle);
+  __atomic_store_n(&lidars[handle].statistic_reset, 1, __ATOMIC_RELEASE);
+  lidars[handle].handle = handle;
+  lidars[handle].info = entry->info;
+  __atomic_store_n(&lidars[handle].device_state, kDeviceStateConnect, __ATOMIC_RELEASE);
+}
+
+static void PublishTopology(livox_driver_core::HubTopologyPtr msg) {
+  msg->header.stamp = ros::Time::now();
+  msg->header.frame_id = "livox_frame";
+  for (int i = 0; i < kMaxLidarCount; i++) {
+    if (topology[i].valid) {
+      livox_driver_core::HubLidar lidar;
+      lidar.handle = i;
+      lidar.slot = topology[i].slot;
+      lidar.id = topology[i].id;
+      lidar.broadcast_code = topology[i].broadcast_code;
+      msg->lidars.push_back(lidar);
+    }
+  }
+  topology_pub.publish(msg);
+}
+
+void HubTopologyPoll(void) {
+  if (!topology_enable) {
+    return;
+  }
+
+  PointCloudQueueReclaim();
+
+  HubTopologyEntry entries[kMaxLidarCount];
+  {
+    boost::mutex::scoped_lock lock(pending_mutex);
+    if (!pending) {
+      return;
+    }
+    memcpy(entries, pending_topology, sizeof(entries));
+    pending = false;
+  }
+
+  livox_driver_core::HubTopologyPtr msg(new livox_driver_core::HubTopology);
+  for (int i = 0; i < kMaxLidarCount; i++) {
+    const HubTopologyEntry *old_entry = &topology[i];
+    const HubTopologyEntry *new_entry = &entries[i];
+    if (new_entry->valid && !old_entry->valid) {
+      ROS_INFO("lidar %d : %s added, slot %d id %d", i, new_entry->broadcast_code, new_entry->slot, new_entry->id);
+      PointCloudQueueAlloc(i);
+      ResetLidar(i, new_entry);
+      StartupOnHubLidar(i, new_entry->broadcast_code);
+      msg->added.push_back(i);
+    } else if (!new_entry->valid && old_entry->valid) {
+      ROS_INFO("lidar %d : %s removed", i, old_entry->broadcast_code);
+      PointCloudQueueRetire(i);
+      OutputsReleaseHandle(i);
+      OutputStreamsReleaseHandle(i);
+      /* only what the sdk thread does not write, the statistic is cleared by it */
+      __atomic_store_n(&lidars[i].device_state, kDeviceStateDisconnect, __ATOMIC_RELEASE);
+      memset(&lidars[i].info, 0, sizeof(lidars[i].info));
+      __atomic_store_n(&lidars[i].statistic_reset, 1, __ATOMIC_RELEASE);
+      msg->removed.push_back(i);
+    } else if (new_entry->valid && !SameLidar(new_entry, old_entry)) {
+      ROS_INFO("lidar %d : %s replaced by %s, slot %d id %d", i, old_entry->broadcast_code,
+               new_entry->broadcast_code, new_entry->slot, new_entry->id);
+      ResetLidar(i, new_entry);
+      msg->changed.push_back(i);
+    } else if (new_entry->valid) {
+      lidars[i].info = new_entry->info;
+    }
+  }
+  memcpy(topology, entries, sizeof(entries));
+
+  if (!msg->added.empty() || !msg->removed.empty() || !msg->changed.empty()) {
+    PublishTopology(msg);
+  }
+}
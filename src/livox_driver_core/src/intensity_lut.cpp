@@ -0,0 +1,109 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "livox_driver_core/intensity_lut.h"
+
+/* next value of the file, skipping white space and # comments */
+static bool ReadToken(FILE *fp, char *token, size_t size) {
+  int c;
+  while ((c = fgetc(fp)) != EOF) {
+    if (c == '#') {
+      while ((c = fgetc(fp)) != EOF && c != '\n') {
+      }
+    } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+      break;
+    }
+  }
+
+  size_t len = 0;
+  while (c != EOF && c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != '#') {
+    if (len + 1 < size) {
+      token[len++] = (char)c;
+    }
+    c = fgetc(fp);
+  }
+  if (c == '#') {
+    ungetc(c, fp);
+  }
+  token[len] = '\0';
+  return len > 0;
+}
+
+static bool ReadKeyValue(FILE *fp, const char *key, double *value) {
+  char token[64];
+  if (!ReadToken(fp, token, sizeof(token)) || strcmp(token, key)) {
+    return false;
+  }
+  return ReadToken(fp, token, sizeof(token)) && (sscanf(token, "%lf", value) == 1);
+}
+
+int IntensityLutLoad(IntensityLut *lut, const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    return -1;
+  }
+
+  double range_step, range_bins;
+  if (!ReadKeyValue(fp, "range_step", &range_step) || !ReadKeyValue(fp, "range_bins", &range_bins) ||
+      (range_step <= 0) || (range_bins < 1) || (range_bins > INTENSITY_LUT_RANGE_BINS)) {
+    fclose(fp);
+    return -1;
+  }
+  lut->range_step = (float)range_step;
+  lut->range_bins = (uint32_t)range_bins;
+
+  char token[64];
+  for (uint32_t bin = 0; bin < lut->range_bins; bin++) {
+    for (uint32_t i = 0; i < INTENSITY_LUT_SIZE; i++) {
+      if (!ReadToken(fp, token, sizeof(token)) || (sscanf(token, "%f", &lut->table[bin][i]) != 1)) {
+        fclose(fp);
+        return -1;
+      }
+    }
+  }
+
+  fclose(fp);
+  return 0;
+}
+
+int IntensityLutSave(const IntensityLut *lut, const char *path) {
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    return -1;
+  }
+
+  fprintf(fp, "# livox intensity lut, one line of 256 values per range bin\n");
+  fprintf(fp, "range_step %g\n", lut->range_step);
+  fprintf(fp, "range_bins %u\n", lut->range_bins);
+  for (uint32_t bin = 0; bin < lut->range_bins; bin++) {
+    for (uint32_t i = 0; i < INTENSITY_LUT_SIZE; i++) {
+      fprintf(fp, (i + 1 < INTENSITY_LUT_SIZE) ? "%.3f " : "%.3f\n", lut->table[bin][i]);
+    }
+  }
+
+  return (fclose(fp) == 0) ? 0 : -1;
+}
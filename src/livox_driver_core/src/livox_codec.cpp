@@ -0,0 +1,275 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string.h>
+
+#include "livox_driver_core/livox_codec.h"
+
+#define BLOCK_HEADER_SIZE               (3)
+#define RICE_PARAM_BITS                 (5)
+#define RICE_ESCAPE                     (24)      // unary length that escapes to a raw 32 bit value
+#define CHANNEL_NUM                     (4)
+
+typedef struct {
+  uint8_t *out;
+  uint64_t acc;
+  uint32_t bits;
+} BitWriter;
+
+typedef struct {
+  const uint8_t *in;
+  const uint8_t *end;
+  uint64_t acc;
+  uint32_t bits;
+  uint32_t overrun;
+} BitReader;
+
+static inline uint32_t ZigZag(uint32_t delta) {
+  return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+}
+
+static inline uint32_t UnZigZag(uint32_t value) {
+  return (value >> 1) ^ (0u - (value & 1));
+}
+
+/* count must be <= 32 */
+static inline void PutBits(BitWriter *writer, uint32_t value, uint32_t count) {
+  writer->acc |= (uint64_t)value << writer->bits;
+  writer->bits += count;
+  while (writer->bits >= 8) {
+    *writer->out++ = (uint8_t)writer->acc;
+    writer->acc >>= 8;
+    writer->bits -= 8;
+  }
+}
+
+static inline void FlushBits(BitWriter *writer) {
+  if (writer->bits) {
+    *writer->out++ = (uint8_t)writer->acc;
+  }
+  writer->acc = 0;
+  writer->bits = 0;
+}
+
+static inline void PutRice(BitWriter *writer, uint32_t value, uint32_t k) {
+  uint32_t q = value >> k;
+  if (q < RICE_ESCAPE) {
+    PutBits(writer, (1u << q) - 1, q + 1);
+    if (k) {
+      PutBits(writer, value & ((1u << k) - 1), k);
+    }
+  } else {
+    PutBits(writer, (1u << RICE_ESCAPE) - 1, RICE_ESCAPE);
+    PutBits(writer, value, 32);
+  }
+}
+
+static inline void Refill(BitReader *reader) {
+  while (reader->bits <= 56) {
+    uint64_t byte = 0;
+    if (reader->in < reader->end) {
+      byte = *reader->in++;
+    } else {
+      reader->overrun += 8;
+    }
+    reader->acc |= byte << reader->bits;
+    reader->bits += 8;
+  }
+}
+
+/* count must be <= 32 */
+static inline uint32_t GetBits(BitReader *reader, uint32_t count) {
+  Refill(reader);
+  uint32_t value = (uint32_t)(reader->acc & ((1ull << count) - 1));
+  reader->acc >>= count;
+  reader->bits -= count;
+  return value;
+}
+
+static inline uint32_t GetRice(BitReader *reader, uint32_t k) {
+  Refill(reader);
+  uint32_t q = __builtin_ctzll(~reader->acc | (1ull << RICE_ESCAPE));
+  if (q >= RICE_ESCAPE) {
+    reader->acc >>= RICE_ESCAPE;
+    reader->bits -= RICE_ESCAPE;
+    return GetBits(reader, 32);
+  }
+
+  reader->acc >>= q + 1;
+  reader->bits -= q + 1;
+  if (!k) {
+    return q;
+  }
+  return (q << k) | GetBits(reader, k);
+}
+
+/* Rice parameter close to the optimum for a geometric distribution of the given mean */
+static uint32_t RiceParam(const uint32_t *values, uint32_t num) {
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < num; ++i) {
+    sum += values[i];
+  }
+
+  uint32_t mean = (uint32_t)(sum / (num ? num : 1));
+  uint32_t k = 0;
+  while ((k < 31) && ((2u << k) <= mean)) {
+    ++k;
+  }
+  return k;
+}
+
+static uint32_t EncodeBlock(const LivoxRawPoint *points, uint32_t num, uint8_t *out) {
+  uint32_t residual[CHANNEL_NUM][LIVOX_CODEC_MAX_BLOCK_POINTS];
+  uint32_t k[CHANNEL_NUM];
+
+  for (uint32_t i = 1; i < num; ++i) {
+    residual[0][i - 1] = ZigZag((uint32_t)points[i].x - (uint32_t)points[i - 1].x);
+    residual[1][i - 1] = ZigZag((uint32_t)points[i].y - (uint32_t)points[i - 1].y);
+    residual[2][i - 1] = ZigZag((uint32_t)points[i].z - (uint32_t)points[i - 1].z);
+    residual[3][i - 1] = ZigZag((uint32_t)points[i].reflectivity - (uint32_t)points[i - 1].reflectivity);
+  }
+  for (uint32_t c = 0; c < CHANNEL_NUM; ++c) {
+    k[c] = RiceParam(residual[c], num - 1);
+  }
+
+  out[0] = (uint8_t)num;
+  memcpy(out + BLOCK_HEADER_SIZE, &points[0], sizeof(LivoxRawPoint));
+
+  BitWriter writer = {out + BLOCK_HEADER_SIZE + sizeof(LivoxRawPoint), 0, 0};
+  for (uint32_t c = 0; c < CHANNEL_NUM; ++c) {
+    PutBits(&writer, k[c], RICE_PARAM_BITS);
+  }
+  for (uint32_t i = 0; i < num - 1; ++i) {
+    PutRice(&writer, residual[0][i], k[0]);
+    PutRice(&writer, residual[1][i], k[1]);
+    PutRice(&writer, residual[2][i], k[2]);
+    PutRice(&writer, residual[3][i], k[3]);
+  }
+  FlushBits(&writer);
+
+  uint32_t payload_size = (uint32_t)(writer.out - out) - BLOCK_HEADER_SIZE;
+  out[1] = (uint8_t)payload_size;
+  out[2] = (uint8_t)(payload_size >> 8);
+
+  return payload_size + BLOCK_HEADER_SIZE;
+}
+
+static int32_t DecodeBlock(const uint8_t *in, uint32_t payload_size, uint32_t num, LivoxRawPoint *points) {
+  if (payload_size < sizeof(LivoxRawPoint)) {
+    return -1;
+  }
+
+  memcpy(&points[0], in, sizeof(LivoxRawPoint));
+
+  BitReader reader = {in + sizeof(LivoxRawPoint), in + payload_size, 0, 0, 0};
+  uint32_t k[CHANNEL_NUM];
+  for (uint32_t c = 0; c < CHANNEL_NUM; ++c) {
+    k[c] = GetBits(&reader, RICE_PARAM_BITS);
+  }
+
+  for (uint32_t i = 1; i < num; ++i) {
+    points[i].x = (int32_t)((uint32_t)points[i - 1].x + UnZigZag(GetRice(&reader, k[0])));
+    points[i].y = (int32_t)((uint32_t)points[i - 1].y + UnZigZag(GetRice(&reader, k[1])));
+    points[i].z = (int32_t)((uint32_t)points[i - 1].z + UnZigZag(GetRice(&reader, k[2])));
+    points[i].reflectivity = (uint8_t)(points[i - 1].reflectivity + UnZigZag(GetRice(&reader, k[3])));
+  }
+
+  /* the accumulator reads ahead, only bits actually consumed may lie past the end */
+  if ((reader.overrun > reader.bits)) {
+    return -1;
+  }
+
+  return (int32_t)num;
+}
+
+uint32_t LivoxCodecMaxEncodedSize(uint32_t num, uint32_t block_points) {
+  if ((block_points == 0) || (block_points > LIVOX_CODEC_MAX_BLOCK_POINTS)) {
+    block_points = LIVOX_CODEC_BLOCK_POINTS;
+  }
+
+  uint32_t blocks = (num + block_points - 1) / block_points;
+  uint32_t worst_point_bits = CHANNEL_NUM * (RICE_ESCAPE + 32);
+  return blocks * (BLOCK_HEADER_SIZE + sizeof(LivoxRawPoint) + 3) + (num * worst_point_bits + 7) / 8;
+}
+
+uint32_t LivoxCodecEncode(const LivoxRawPoint *points, uint32_t num, uint32_t block_points, uint8_t *out) {
+  if ((block_points == 0) || (block_points > LIVOX_CODEC_MAX_BLOCK_POINTS)) {
+    block_points = LIVOX_CODEC_BLOCK_POINTS;
+  }
+
+  uint8_t *p_out = out;
+  while (num) {
+    uint32_t block_num = (num < block_points) ? num : block_points;
+    p_out += EncodeBlock(points, block_num, p_out);
+    points += block_num;
+    num -= block_num;
+  }
+
+  return (uint32_t)(p_out - out);
+}
+
+int32_t LivoxCodecDecodedCount(const uint8_t *in, uint32_t size) {
+  int32_t count = 0;
+  uint32_t offset = 0;
+
+  while (offset < size) {
+    if ((size - offset) < BLOCK_HEADER_SIZE) {
+      return -1;
+    }
+    uint32_t payload_size = in[offset + 1] | (in[offset + 2] << 8);
+    count += in[offset];
+    offset += BLOCK_HEADER_SIZE + payload_size;
+  }
+
+  return (offset == size) ? count : -1;
+}
+
+int32_t LivoxCodecDecode(const uint8_t *in, uint32_t size, LivoxRawPoint *points, uint32_t max_points) {
+  int32_t count = 0;
+  uint32_t offset = 0;
+
+  while (offset < size) {
+    if ((size - offset) < BLOCK_HEADER_SIZE) {
+      return -1;
+    }
+
+    uint32_t num = in[offset];
+    uint32_t payload_size = in[offset + 1] | (in[offset + 2] << 8);
+    offset += BLOCK_HEADER_SIZE;
+    if ((payload_size > (size - offset)) || (num == 0)) {
+      return -1;
+    }
+    if ((count + num) > max_points) {
+      break;
+    }
+
+    if (DecodeBlock(in + offset, payload_size, num, points + count) < 0) {
+      return -1;
+    }
+    count += num;
+    offset += payload_size;
+  }
+
+  return count;
+}
@@ -0,0 +1,172 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+
+#include "livox_driver_core/outlier_filter.h"
+#include "livox_driver_core/voxel_key.h"
+
+/* slot of key, an empty slot to insert into if key is not in the table */
+static inline OutlierFilterSlot *FindSlot(OutlierFilter *filter, uint64_t key) {
+  uint32_t mask = (1u << filter->slot_bits) - 1;
+  uint32_t index = VoxelKeyHash(key, filter->slot_bits);
+  OutlierFilterSlot *slots = &filter->slots[0];
+  while ((slots[index].frame == filter->frame) && (slots[index].key != key)) {
+    index = (index + 1) & mask;
+  }
+  return &slots[index];
+}
+
+void OutlierFilterInit(OutlierFilter *filter, const OutlierFilterConfig &config) {
+  filter->config = config;
+  filter->slot_bits = 0;
+  filter->frame = 0;
+}
+
+uint32_t OutlierFilterClassify(OutlierFilter *filter, const LivoxRawPoint *points, uint32_t num,
+                               uint8_t *keep) {
+  const OutlierFilterConfig &config = filter->config;
+  if (!num) {
+    return 0;
+  }
+
+  /* keep the table at most half full */
+  uint32_t bits = 4;
+  while ((1u << bits) < 2 * num) {
+    bits++;
+  }
+  if (bits > filter->slot_bits) {
+    filter->slot_bits = bits;
+    OutlierFilterSlot empty = { 0, 0, 0, 0 };
+    filter->slots.assign(1u << bits, empty);
+    filter->frame = 0;
+  }
+
+  /* 0 marks slots never written */
+  if (++filter->frame == 0) {
+    for (size_t i = 0; i < filter->slots.size(); ++i) {
+      filter->slots[i].frame = 0;
+    }
+    filter->frame = 1;
+  }
+
+  filter->x.resize(num);
+  filter->y.resize(num);
+  filter->z.resize(num);
+  filter->point_slot.resize(num);
+  filter->cell_points.resize(num);
+  float *x = &filter->x[0];
+  float *y = &filter->y[0];
+  float *z = &filter->z[0];
+  uint32_t *point_slot = &filter->point_slot[0];
+  uint32_t *cell_points = &filter->cell_points[0];
+  float inv_cell = 0.5f / config.radius;
+
+  /* count the points of every occupied cell */
+  filter->occupied.clear();
+  for (uint32_t i = 0; i < num; ++i) {
+    x[i] = points[i].x / 1000.0f;
+    y[i] = points[i].y / 1000.0f;
+    z[i] = points[i].z / 1000.0f;
+    uint64_t key = VoxelKey((int32_t)floorf(x[i] * inv_cell), (int32_t)floorf(y[i] * inv_cell),
+                           (int32_t)floorf(z[i] * inv_cell));
+    OutlierFilterSlot *slot = FindSlot(filter, key);
+    if (slot->frame != filter->frame) {
+      slot->frame = filter->frame;
+      slot->key = key;
+      slot->count = 0;
+      filter->occupied.push_back(slot - &filter->slots[0]);
+    }
+    slot->count++;
+    point_slot[i] = slot - &filter->slots[0];
+  }
+
+  /* group the points by cell, end runs from the start to the end of each group */
+  OutlierFilterSlot *slots = &filter->slots[0];
+  uint32_t start = 0;
+  for (size_t i = 0; i < filter->occupied.size(); ++i) {
+    OutlierFilterSlot *slot = &slots[filter->occupied[i]];
+    slot->end = start;
+    start += slot->count;
+  }
+  for (uint32_t i = 0; i < num; ++i) {
+    cell_points[slots[point_slot[i]].end++] = i;
+  }
+
+  /*
+   * count neighbors within radius of every point, cells are twice the
+   * radius so the sphere around a point only reaches into the neighbor
+   * cells on the side of the cell half it lies in, 8 cells in all
+   */
+  float radius2 = config.radius * config.radius;
+  float reference2 = config.reference_range * config.reference_range;
+  uint32_t outliers = 0;
+  for (uint32_t i = 0; i < num; ++i) {
+    if (!points[i].x && !points[i].y && !points[i].z) {
+      keep[i] = 1;
+      continue;
+    }
+
+    uint32_t needed = config.min_neighbors;
+    float range2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+    if (range2 > reference2) {
+      needed = (uint32_t)ceilf(config.min_neighbors * reference2 / range2);
+      needed = needed ? needed : 1;
+    }
+
+    float fx = x[i] * inv_cell;
+    float fy = y[i] * inv_cell;
+    float fz = z[i] * inv_cell;
+    int32_t cx = (int32_t)floorf(fx);
+    int32_t cy = (int32_t)floorf(fy);
+    int32_t cz = (int32_t)floorf(fz);
+    int32_t sx = (fx - cx < 0.5f) ? -1 : 1;
+    int32_t sy = (fy - cy < 0.5f) ? -1 : 1;
+    int32_t sz = (fz - cz < 0.5f) ? -1 : 1;
+    uint32_t neighbors = 0;
+    for (int32_t dx = 0; (dx <= 1) && (neighbors < needed); ++dx) {
+      for (int32_t dy = 0; (dy <= 1) && (neighbors < needed); ++dy) {
+        for (int32_t dz = 0; (dz <= 1) && (neighbors < needed); ++dz) {
+          const OutlierFilterSlot *slot = FindSlot(filter, VoxelKey(cx + dx * sx, cy + dy * sy, cz + dz * sz));
+          if (slot->frame != filter->frame) {
+            continue;
+          }
+
+          for (uint32_t k = slot->end - slot->count; (k < slot->end) && (neighbors < needed); ++k) {
+            uint32_t j = cell_points[k];
+            float ex = x[j] - x[i];
+            float ey = y[j] - y[i];
+            float ez = z[j] - z[i];
+            neighbors += (j != i) && (ex * ex + ey * ey + ez * ez <= radius2);
+          }
+        }
+      }
+    }
+
+    keep[i] = (neighbors >= needed);
+    outliers += !keep[i];
+  }
+
+  return outliers;
+}
@@ -0,0 +1,259 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+
+#include "livox_driver_core/output_stream.h"
+#include "livox_driver_core/driver_core.h"
+#include "livox_driver_core/voxel_key.h"
+
+#define OUTPUT_STREAM_FRAME_POINTS_MAX  (4*1024*1024)
+
+OutputStream output_streams[OUTPUT_STREAM_MAX];
+uint32_t output_stream_count = 0;
+
+void OutputStreamsInit(ros::NodeHandle &private_node, const std::string &topic) {
+  std::vector<std::string> names;
+  private_node.getParam("output_streams", names);
+  if (names.size() > OUTPUT_STREAM_MAX) {
+    ROS_WARN("%u output streams, only the first %d are published", (uint32_t)names.size(), OUTPUT_STREAM_MAX);
+    names.resize(OUTPUT_STREAM_MAX);
+  }
+
+  output_stream_count = 0;
+  for (size_t i = 0; i < names.size(); ++i) {
+    int frame_points, decimation;
+    double voxel_size;
+    std::string stream_topic;
+    private_node.param(names[i] + "/frame_points", frame_points, POINTS_PER_FRAME);
+    private_node.param(names[i] + "/decimation", decimation, 1);
+    private_node.param(names[i] + "/voxel_size", voxel_size, 0.0);
+    private_node.param(names[i] + "/topic", stream_topic, topic + "_" + names[i]);
+    if ((frame_points <= 0) || (frame_points > OUTPUT_STREAM_FRAME_POINTS_MAX) || (decimation <= 0) ||
+        (voxel_size < 0)) {
+      ROS_WARN("Invalid output stream %s config, output stream disabled", names[i].c_str());
+      continue;
+    }
+
+    OutputStream *stream = &output_streams[output_stream_count++];
+    stream->name = names[i];
+    stream->topic = stream_topic;
+    stream->frame_points = frame_points;
+    stream->decimation = decimation;
+    stream->voxel_size = voxel_size;
+    stream->point_times = false;
+    stream->seq = 0;
+
+    /* keep the voxel table of a frame at most half full */
+    stream->slot_bits = 4;
+    while ((1u << stream->slot_bits) < 2 * ((stream->frame_points + decimation - 1) / decimation)) {
+      stream->slot_bits++;
+    }
+
+    ROS_INFO("Output stream %s on %s, %d points per frame, every %d point, voxel %.3fm", names[i].c_str(),
+             stream_topic.c_str(), frame_points, decimation, voxel_size);
+  }
+}
+
+void OutputStreamsReleaseHandle(uint8_t handle) {
+  for (uint32_t i = 0; i < output_stream_count; ++i) {
+    output_streams[i].frames[handle].active = false;
+  }
+}
+
+void OutputStreamFrameReset(OutputStream *stream, OutputStreamFrame *frame) {
+  frame->ingested = 0;
+  frame->points.clear();
+  frame->points.reserve((stream->frame_points + stream->decimation - 1) / stream->decimation);
+  if (stream->point_times) {
+    frame->times_valid = true;
+    frame->first_packet_ns = 0;
+    frame->point_interval_ns = 0;
+    frame->point_times.clear();
+    frame->point_times.reserve(frame->points.capacity());
+  }
+  if (stream->voxel_size <= 0) {
+    return;
+  }
+
+  if (frame->slots.empty()) {
+    OutputStreamSlot empty = { 0, 0 };
+    frame->slots.assign(1u << stream->slot_bits, empty);
+    frame->voxel_frame = 0;
+  }
+  /* 0 marks slots never written */
+  if (++frame->voxel_frame == 0) {
+    for (size_t i = 0; i < frame->slots.size(); ++i) {
+      frame->slots[i].frame = 0;
+    }
+    frame->voxel_frame = 1;
+  }
+}
+
+/* true for the first point of its voxel in the frame */
+static inline bool FirstOfVoxel(const OutputStream *stream, OutputStreamFrame *frame, const LivoxRawPoint *point,
+                                float inv_voxel_mm) {
+  uint64_t key = VoxelKey((int32_t)floorf(point->x * inv_voxel_mm), (int32_t)floorf(point->y * inv_voxel_mm),
+                          (int32_t)floorf(point->z * inv_voxel_mm));
+  OutputStreamSlot *slots = &frame->slots[0];
+  uint32_t mask = (1u << stream->slot_bits) - 1;
+  uint32_t slot = VoxelKeyHash(key, stream->slot_bits);
+  while (slots[slot].frame == frame->voxel_frame) {
+    if (slots[slot].key == key) {
+      return false;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  slots[slot].key = key;
+  slots[slot].frame = frame->voxel_frame;
+  return true;
+}
+
+/* record the packet of a kept point, the next point of the frame is point of the queue */
+static void KeepTime(OutputStreamFrame *frame, PointCloudQueue *queue, uint32_t point_idx) {
+  OutputStreamPointTime time = { frame->ingested + (point_idx - frame->cursor), 0, 0 };
+  const PacketStamp *stamp = frame->times_valid ? QueuePointPacket(queue, point_idx, &frame->stamp_rd) : NULL;
+  if (!stamp || !stamp->sensor_ns) {
+    frame->times_valid = false;
+  } else if (!frame->first_packet_ns) {
+    frame->first_packet_ns = stamp->sensor_ns;
+  } else if (stamp->point_idx != frame->last_packet_idx) {
+    if ((stamp->sensor_ns <= frame->last_packet_ns) || (stamp->sensor_ns - frame->first_packet_ns > 0xFFFFFFFFull)) {
+      frame->times_valid = false;
+    } else {
+      /* a lost or skipped packet only widens a pair, the closest pair is the sampling rate */
+      uint32_t pair_ns = (uint32_t)((stamp->sensor_ns - frame->last_packet_ns) /
+                                    (stamp->point_idx - frame->last_packet_idx));
+      if (!frame->point_interval_ns || (pair_ns < frame->point_interval_ns)) {
+        frame->point_interval_ns = pair_ns;
+      }
+    }
+  }
+
+  if (frame->times_valid) {
+    frame->last_packet_ns = stamp->sensor_ns;
+    frame->last_packet_idx = stamp->point_idx;
+    time.packet_point = (int32_t)(time.point - (point_idx - stamp->point_idx));
+    time.packet_ns = (uint32_t)(stamp->sensor_ns - frame->first_packet_ns);
+  }
+  frame->point_times.push_back(time);
+}
+
+static inline void KeepPoint(const OutputStream *stream, OutputStreamFrame *frame, PointCloudQueue *queue,
+                             const LivoxRawPoint *point, uint32_t point_idx) {
+  frame->points.push_back(*point);
+  if (stream->point_times) {
+    KeepTime(frame, queue, point_idx);
+  }
+}
+
+/* copy the kept points of one contiguous run of the queue from the cursor into the frame */
+static void KeepPoints(const OutputStream *stream, OutputStreamFrame *frame, PointCloudQueue *queue,
+                       const LivoxRawPoint *points, uint32_t num) {
+  uint32_t decimation = stream->decimation;
+  uint32_t i = (decimation - frame->ingested % decimation) % decimation;
+  if (stream->voxel_size <= 0) {
+    for (; i < num; i += decimation) {
+      KeepPoint(stream, frame, queue, &points[i], frame->cursor + i);
+    }
+    return;
+  }
+
+  float inv_voxel_mm = 1.0f / (stream->voxel_size * 1000.0f);
+  for (; i < num; i += decimation) {
+    if (FirstOfVoxel(stream, frame, &points[i], inv_voxel_mm)) {
+      KeepPoint(stream, frame, queue, &points[i], frame->cursor + i);
+    }
+  }
+}
+
+const FrameTimes *OutputStreamFrameTimes(OutputStreamFrame *frame) {
+  uint32_t num = frame->point_times.size();
+  uint32_t interval_ns = frame->point_interval_ns ? frame->point_interval_ns : POINT_INTERVAL_NS;
+  int64_t first_ns = 0;
+
+  frame->offsets.resize(num);
+  for (uint32_t i = 0; i < num; i++) {
+    const OutputStreamPointTime *time = &frame->point_times[i];
+    int64_t ns = frame->times_valid ?
+                 time->packet_ns + (int64_t)(time->point - time->packet_point) * interval_ns :
+                 (int64_t)time->point * POINT_INTERVAL_NS;
+    if (!i) {
+      first_ns = ns;
+    }
+    frame->offsets[i].point = i;
+    frame->offsets[i].offset_ns = (ns > first_ns) ? (uint32_t)(ns - first_ns) : 0;
+  }
+
+  frame->times.packets = num ? &frame->offsets[0] : NULL;
+  frame->times.count = num;
+  frame->times.point_interval_ns = interval_ns;
+  return &frame->times;
+}
+
+bool OutputStreamAssemble(OutputStream *stream, uint8_t handle, PointCloudQueue *queue, uint32_t wr_idx) {
+  OutputStreamFrame *frame = &stream->frames[handle];
+  uint32_t rd_idx = queue->rd_idx;
+
+  /* new queue, or its points were flushed or reset under the cursor */
+  if (!frame->active || ((int32_t)(rd_idx - frame->cursor) > 0) || ((int32_t)(wr_idx - frame->cursor) < 0)) {
+    frame->active = true;
+    frame->cursor = rd_idx;
+    frame->stamp_rd = queue->stamp_rd;
+    OutputStreamFrameReset(stream, frame);
+  }
+
+  /* nobody subscribes, follow the queue without reading it */
+  if (!stream->pub.getNumSubscribers()) {
+    frame->cursor = wr_idx;
+    if (frame->ingested) {
+      OutputStreamFrameReset(stream, frame);
+    }
+    return false;
+  }
+
+  uint32_t num = wr_idx - frame->cursor;
+  if (num > stream->frame_points - frame->ingested) {
+    num = stream->frame_points - frame->ingested;
+  }
+  if (num && !frame->ingested) {
+    frame->stamp = QueuePointStamp(handle, queue, frame->cursor, &frame->stamp_rd);
+  }
+
+  /* at most two runs around the end of the ring */
+  while (num) {
+    uint32_t rd = frame->cursor & queue->mask;
+    uint32_t run = queue->size - rd;
+    if (run > num) {
+      run = num;
+    }
+    KeepPoints(stream, frame, queue, &queue->buffer[rd], run);
+    frame->cursor += run;
+    frame->ingested += run;
+    num -= run;
+  }
+
+  return frame->ingested == stream->frame_points;
+}
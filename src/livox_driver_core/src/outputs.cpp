@@ -0,0 +1,739 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include <std_msgs/Float64.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/image_encodings.h>
+#include <std_srvs/Trigger.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <tf/transform_listener.h>
+
+#include "livox_driver_core/outputs.h"
+#include "livox_driver_core/driver_core.h"
+#include "livox_driver_core/compact_cloud.h"
+#include "livox_driver_core/livox_codec.h"
+#include "livox_driver_core/shm_ring.h"
+#include "livox_driver_core/range_image.h"
+#include "livox_driver_core/ground_segment.h"
+#include "livox_driver_core/voxel_map.h"
+#include "livox_driver_core/height_grid.h"
+#include "livox_driver_core/point_dedup.h"
+#include "livox_driver_core/publisher_qos.h"
+#include "livox_driver_core/CompressedCloud.h"
+#include "livox_driver_core/DedupStats.h"
+
+#define ACCUMULATE_WINDOW_DEFAULT       (0.0)     // s, 0 disables accumulation
+#define ACCUMULATE_RATE_DEFAULT         (10.0)    // hz
+#define DEDUP_RESOLUTION_DEFAULT        (0.0)     // m, 0 disables deduplication
+
+#define SHM_SLOTS_DEFAULT               (16)      // must be 2^n
+
+#define RANGE_IMAGE_FOV_DEFAULT         (38.4)    // degree, circular fov of mid-40
+#define RANGE_IMAGE_SIZE_DEFAULT        (192)     // 0.2 degree per pixel
+
+#define GROUND_CELL_SIZE_DEFAULT        (0.5)     // m
+#define GROUND_RANGE_DEFAULT            (50.0)    // m
+#define GROUND_SENSOR_HEIGHT_DEFAULT    (1.0)     // m, lidar above ground
+#define GROUND_HEIGHT_TOLERANCE_DEFAULT (0.3)     // m
+#define GROUND_THICKNESS_DEFAULT        (0.15)    // m
+
+#define MAP_VOXEL_SIZE_DEFAULT          (0.05)    // m
+#define MAP_MAX_VOXELS_DEFAULT          (4000000) // 128MB of hash table
+#define MAP_PUBLISH_PERIOD_DEFAULT      (5.0)     // s
+#define MAP_SAVE_PATH_DEFAULT           "livox_map.pcd"
+
+#define GRID_RESOLUTION_DEFAULT         (0.2)     // m
+#define GRID_SIZE_DEFAULT               (40.0)    // m, side of the window
+#define GRID_OBSTACLE_HEIGHT_DEFAULT    (0.3)     // m
+#define GRID_DECAY_DEFAULT              (1.0)     // s
+#define GRID_RATE_DEFAULT               (5.0)     // hz
+#define GRID_TF_TIMEOUT                 (0.02)    // s, wait for the pose at the stamp of a frame
+
+/* for output publisher use */
+static ros::Publisher accumulated_pub;
+static ros::Publisher dedup_pub;
+static ros::Publisher compact_pub;
+static ros::Publisher compact_scale_pub;
+static ros::Publisher compressed_pub;
+static ros::Publisher range_image_pub;
+static ros::Publisher intensity_image_pub;
+static ros::Publisher count_image_pub;
+static ros::Publisher ground_pub;
+static ros::Publisher obstacles_pub;
+static ros::Publisher map_pub;
+static ros::ServiceServer save_map_srv;
+static ros::Publisher grid_pub;
+static ros::Publisher grid_elevation_pub;
+
+/*
+ * outputs with subscribers for the next frame, by OutputsFrameNeed. The
+ * accumulate window and the height grid are fed while enabled, so a new
+ * subscriber gets them filled, only their publishing waits for subscribers.
+ */
+typedef struct {
+  bool compact;
+  bool compressed;
+  bool range_image;
+  bool ground;
+} OutputsWanted;
+
+static OutputsWanted outputs_wanted;
+
+/* layout of the converted points handed over by the publish path */
+static uint32_t output_point_step;
+static const std::vector<sensor_msgs::PointField> *output_fields;
+
+/* for sliding-window accumulation use */
+static FrameWindow frame_window;
+static bool accumulate_enable = false;
+static ros::Duration accumulate_period;
+static ros::Time last_accumulate_time;
+static bool dedup_enable = false;
+static PointDedup point_dedup;
+
+/* for compact output use */
+static CompactFormat compact_format = kCompactFormatNone;
+
+/* for compressed output use */
+static bool compress_enable = false;
+static std::vector<uint8_t> compress_buffer;
+
+/* for shared memory output use, rings are created on the first frame of a handle */
+static bool shm_enable = false;
+static int shm_slots = SHM_SLOTS_DEFAULT;
+static std::string shm_prefix;
+static ShmRing shm_rings[kMaxLidarCount];
+
+/* for range image output use */
+static bool range_image_enable = false;
+static RangeImage range_image;
+
+/* for ground segmentation output use */
+static bool ground_enable = false;
+static GroundSegment ground_segment;
+static std::vector<uint8_t> ground_labels;
+
+/* for voxel map output use */
+static bool map_enable = false;
+static VoxelMap voxel_map;
+static std::string map_save_path;
+static ros::Duration map_publish_period;
+static ros::Time last_map_publish_time;
+
+/* for height grid output use, the window follows livox_frame inside grid_frame */
+static bool grid_enable = false;
+static HeightGrid height_grid;
+static std::string grid_frame;
+static tf::TransformListener *grid_tf_listener = NULL;
+static ros::Time grid_start_time;
+static ros::Duration grid_period;
+static ros::Time last_grid_publish_time;
+
+static void PublishCompactCloud(const LivoxRawPoint *raw_points, uint32_t num, const ros::Time &stamp) {
+  sensor_msgs::PointCloud2Ptr compact_cloud(new sensor_msgs::PointCloud2);
+  compact_cloud->header.frame_id = "livox_frame";
+  compact_cloud->header.stamp = stamp;
+
+  uint32_t dropped = CompactCloudFill(compact_cloud.get(), compact_format, raw_points, num);
+  if (dropped) {
+    ROS_WARN_THROTTLE(1.0, "%u points out of %s range", dropped, CompactFormatName(compact_format));
+  }
+
+  compact_pub.publish(compact_cloud);
+}
+
+static void PublishCompressedCloud(const LivoxRawPoint *raw_points, uint32_t num, const ros::Time &stamp) {
+  livox_driver_core::CompressedCloudPtr compressed(new livox_driver_core::CompressedCloud);
+  compressed->header.frame_id = "livox_frame";
+  compressed->header.stamp = stamp;
+  compressed->format = LIVOX_CODEC_FORMAT;
+  compressed->point_count = num;
+  compressed->scale = 0.001f;
+
+  uint32_t size = LivoxCodecEncode(raw_points, num, LIVOX_CODEC_BLOCK_POINTS, &compress_buffer[0]);
+  compressed->data.assign(compress_buffer.begin(), compress_buffer.begin() + size);
+
+  compressed_pub.publish(compressed);
+}
+
+static void WriteShmRing(uint8_t handle, const LivoxRawPoint *raw_points, uint32_t num, const ros::Time &stamp) {
+  ShmRing *ring = &shm_rings[handle];
+  if (!ring->base) {
+    char name[SHM_RING_NAME_SIZE];
+    snprintf(name, sizeof(name), "%s_%d", shm_prefix.c_str(), handle);
+    if (ShmRingCreate(ring, name, handle, shm_slots, POINTS_PER_FRAME)) {
+      ROS_WARN_THROTTLE(1.0, "Create shared memory ring %s failed", name);
+      return;
+    }
+    ROS_INFO("Shared memory ring %s, %d slots", name, shm_slots);
+  }
+
+  ShmPoint *points = ShmRingBeginWrite(ring);
+  for (uint32_t i = 0; i < num; i++) {
+    points[i].x = raw_points[i].x/1000.0f;
+    points[i].y = raw_points[i].y/1000.0f;
+    points[i].z = raw_points[i].z/1000.0f;
+    points[i].intensity = (float) raw_points[i].reflectivity;
+  }
+  ShmRingEndWrite(ring, num, stamp.toNSec());
+}
+
+static sensor_msgs::ImagePtr MakeImage(const std::string &encoding, uint32_t bytes_per_pixel,
+                                       const void *data, const ros::Time &stamp) {
+  sensor_msgs::ImagePtr image(new sensor_msgs::Image);
+  image->header.frame_id = "livox_frame";
+  image->header.stamp = stamp;
+  image->height = range_image.config.rows;
+  image->width = range_image.config.cols;
+  image->encoding = encoding;
+  image->is_bigendian = false;
+  image->step = image->width * bytes_per_pixel;
+
+  const uint8_t *bytes = (const uint8_t *)data;
+  image->data.assign(bytes, bytes + image->step * image->height);
+  return image;
+}
+
+static void PublishRangeImage(const LivoxRawPoint *raw_points, uint32_t num, const ros::Time &stamp) {
+  RangeImageProject(&range_image, raw_points, num);
+
+  range_image_pub.publish(MakeImage(sensor_msgs::image_encodings::TYPE_32FC1, sizeof(float),
+                                    &range_image.range[0], stamp));
+  intensity_image_pub.publish(MakeImage(sensor_msgs::image_encodings::MONO8, sizeof(uint8_t),
+                                        &range_image.intensity[0], stamp));
+  count_image_pub.publish(MakeImage(sensor_msgs::image_encodings::MONO16, sizeof(uint16_t),
+                                    &range_image.count[0], stamp));
+}
+
+static sensor_msgs::PointCloud2Ptr MakeLayoutCloud(const ros::Time &stamp, uint32_t num) {
+  sensor_msgs::PointCloud2Ptr cloud(new sensor_msgs::PointCloud2);
+  cloud->header.frame_id = "livox_frame";
+  cloud->header.stamp = stamp;
+  cloud->height = 1;
+  cloud->width = num;
+  cloud->fields = *output_fields;
+  cloud->is_bigendian = false;
+  cloud->point_step = output_point_step;
+  cloud->row_step = output_point_step * num;
+  cloud->data.resize(cloud->row_step);
+  cloud->is_dense = true;
+  return cloud;
+}
+
+/* split the converted frame into ground and obstacle points, same layout as <topic> */
+static void PublishGroundSegments(const LivoxRawPoint *raw_points, uint32_t num, const FrameSegment &segment) {
+  ground_labels.resize(num);
+  uint32_t ground_count = num ? GroundSegmentClassify(&ground_segment, raw_points, num, &ground_labels[0]) : 0;
+
+  sensor_msgs::PointCloud2Ptr ground = MakeLayoutCloud(segment.stamp, ground_count);
+  sensor_msgs::PointCloud2Ptr obstacles = MakeLayoutCloud(segment.stamp, num - ground_count);
+  uint8_t *ground_data = ground_count ? &ground->data[0] : NULL;
+  uint8_t *obstacles_data = (num - ground_count) ? &obstacles->data[0] : NULL;
+  const uint8_t *point = segment.data;
+  for (uint32_t i = 0; i < num; ++i, point += output_point_step) {
+    if (ground_labels[i]) {
+      memcpy(ground_data, point, output_point_step);
+      ground_data += output_point_step;
+    } else {
+      memcpy(obstacles_data, point, output_point_step);
+      obstacles_data += output_point_step;
+    }
+  }
+
+  ground_pub.publish(ground);
+  obstacles_pub.publish(obstacles);
+}
+
+static void PublishVoxelMap(void) {
+  ros::Time now = ros::Time::now();
+  if ((now - last_map_publish_time) < map_publish_period) {
+    return;
+  }
+  last_map_publish_time = now;
+
+  sensor_msgs::PointCloud2Ptr map_cloud(new sensor_msgs::PointCloud2);
+  map_cloud->header.frame_id = "livox_frame";
+  map_cloud->header.stamp = now;
+  VoxelMapSnapshot(&voxel_map, map_cloud.get());
+  map_pub.publish(map_cloud);
+
+  if (voxel_map.dropped_points) {
+    ROS_WARN_THROTTLE(60.0, "Voxel map full at %u voxels, %lu points of new voxels dropped",
+                      voxel_map.voxel_count, (unsigned long)voxel_map.dropped_points);
+  }
+}
+
+static bool SaveVoxelMap(std::string *message) {
+  char text[256];
+  bool success = (VoxelMapSave(&voxel_map, map_save_path.c_str()) == 0);
+  if (success) {
+    snprintf(text, sizeof(text), "Saved %u voxels of %lu points to %s", voxel_map.voxel_count,
+             (unsigned long)voxel_map.point_count, map_save_path.c_str());
+  } else {
+    snprintf(text, sizeof(text), "Save voxel map to %s failed", map_save_path.c_str());
+  }
+  ROS_INFO("%s", text);
+  *message = text;
+  return success;
+}
+
+static bool OnSaveMap(std_srvs::Trigger::Request& request, std_srvs::Trigger::Response& response) {
+  response.success = SaveVoxelMap(&response.message);
+  return true;
+}
+
+static uint32_t GridTimeMs(const ros::Time &now) {
+  return (uint32_t)((now - grid_start_time).toNSec() / 1000000);
+}
+
+/* insert a frame at the pose of livox_frame in grid_frame at its stamp, scrolling the window along */
+static void UpdateHeightGrid(const LivoxRawPoint *raw_points, uint32_t num, const ros::Time &stamp) {
+  HeightGridTransform transform;
+  memset(&transform, 0, sizeof(transform));
+  transform.rotation[0][0] = transform.rotation[1][1] = transform.rotation[2][2] = 1.0f;
+
+  if (grid_tf_listener) {
+    tf::StampedTransform stamped;
+    std::string error;
+    if (!grid_tf_listener->waitForTransform(grid_frame, "livox_frame", stamp, ros::Duration(GRID_TF_TIMEOUT),
+                                            ros::Duration(0.001), &error)) {
+      ROS_WARN_THROTTLE(1.0, "Height grid skips frame, %s", error.c_str());
+      return;
+    }
+    try {
+      grid_tf_listener->lookupTransform(grid_frame, "livox_frame", stamp, stamped);
+    } catch (tf::TransformException &e) {
+      ROS_WARN_THROTTLE(1.0, "Height grid skips frame, %s", e.what());
+      return;
+    }
+
+    for (int i = 0; i < 3; i++) {
+      transform.rotation[i][0] = stamped.getBasis()[i].x();
+      transform.rotation[i][1] = stamped.getBasis()[i].y();
+      transform.rotation[i][2] = stamped.getBasis()[i].z();
+    }
+    transform.translation[0] = stamped.getOrigin().x();
+    transform.translation[1] = stamped.getOrigin().y();
+    transform.translation[2] = stamped.getOrigin().z();
+    HeightGridRecenter(&height_grid, transform.translation[0], transform.translation[1]);
+  }
+
+  HeightGridInsert(&height_grid, raw_points, num, transform, GridTimeMs(ros::Time::now()));
+}
+
+static void PublishHeightGrid(void) {
+  ros::Time now = ros::Time::now();
+  if (((now - last_grid_publish_time) < grid_period) ||
+      (!grid_pub.getNumSubscribers() && !grid_elevation_pub.getNumSubscribers())) {
+    return;
+  }
+  last_grid_publish_time = now;
+
+  if (grid_pub.getNumSubscribers()) {
+    nav_msgs::OccupancyGridPtr occupancy(new nav_msgs::OccupancyGrid);
+    occupancy->header.frame_id = grid_frame;
+    occupancy->header.stamp = now;
+    occupancy->info.map_load_time = now;
+    HeightGridFillOccupancy(&height_grid, GridTimeMs(now), occupancy.get());
+    grid_pub.publish(occupancy);
+  }
+
+  if (grid_elevation_pub.getNumSubscribers()) {
+    sensor_msgs::ImagePtr elevation(new sensor_msgs::Image);
+    elevation->header.frame_id = grid_frame;
+    elevation->header.stamp = now;
+    HeightGridFillElevation(&height_grid, GridTimeMs(now), elevation.get());
+    grid_elevation_pub.publish(elevation);
+  }
+}
+
+/* publish the frames of the last accumulate_window seconds as one cloud */
+static void PublishAccumulatedCloud(void) {
+  ros::Time now = ros::Time::now();
+  FrameWindowAgeOut(&frame_window, now);
+  if ((now - last_accumulate_time) < accumulate_period) {
+    return;
+  }
+  if (!accumulated_pub.getNumSubscribers() && !(dedup_enable && dedup_pub.getNumSubscribers())) {
+    return;
+  }
+  last_accumulate_time = now;
+
+  AccumulatedCloudPtr accumulated = FrameWindowSnapshot(&frame_window);
+  accumulated->header.frame_id = "livox_frame";
+  accumulated->header.stamp = now;
+
+  /* frames of overlapping lidars meet in the window, keep one point per voxel */
+  if (dedup_enable) {
+    PointDedupRun(&point_dedup, accumulated->segments, &accumulated->kept);
+    accumulated->deduplicated = true;
+
+    livox_driver_core::DedupStatsPtr stats(new livox_driver_core::DedupStats);
+    stats->header = accumulated->header;
+    stats->points = accumulated->width;
+    stats->kept = accumulated->kept.size();
+    stats->ratio = accumulated->width ? (float)stats->kept / accumulated->width : 1.0f;
+    dedup_pub.publish(stats);
+
+    accumulated->width = accumulated->kept.size();
+  }
+
+  accumulated_pub.publish(accumulated);
+}
+
+static void AccumulateInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic,
+                           uint32_t point_step, const std::vector<sensor_msgs::PointField> *fields) {
+  double accumulate_window;
+  double accumulate_rate;
+  double dedup_resolution;
+  std::string dedup_keep;
+  private_node.param("accumulate_window", accumulate_window, ACCUMULATE_WINDOW_DEFAULT);
+  private_node.param("accumulate_rate", accumulate_rate, ACCUMULATE_RATE_DEFAULT);
+  private_node.param("dedup_resolution", dedup_resolution, DEDUP_RESOLUTION_DEFAULT);
+  private_node.param("dedup_keep", dedup_keep, std::string("reflectivity"));
+  if ((accumulate_window <= 0) || (accumulate_rate <= 0)) {
+    if (dedup_resolution > 0) {
+      ROS_WARN("dedup_resolution needs accumulate_window, deduplication disabled");
+    }
+    return;
+  }
+
+  /* frames of all lidars inside the window, with room for twice the frame rate of a mid-40 */
+  double frame_period = POINTS_PER_FRAME * POINT_INTERVAL_NS / 1e9;
+  double max_segments = 2.0 * kMaxLidarCount * accumulate_window / frame_period;
+  ROS_INFO("Accumulate window %.3fs at %.1fhz", accumulate_window, accumulate_rate);
+  FrameWindowInit(&frame_window, accumulate_window, (uint32_t)std::min(max_segments, (double)WINDOW_SEGMENTS_MAX),
+                  point_step, fields);
+  accumulate_period = ros::Duration(1.0 / accumulate_rate);
+  accumulate_enable = true;
+  accumulated_pub = node.advertise<AccumulatedCloud>(topic + "_accumulated", 1);
+
+  if (dedup_resolution > 0) {
+    DedupPolicy policy = DedupPolicyFromString(dedup_keep);
+    if (!PointDedupInit(&point_dedup, dedup_resolution, policy, point_step, fields)) {
+      ROS_WARN("Point layout has no x/y/z, deduplication disabled");
+      return;
+    }
+    ROS_INFO("Deduplicate accumulated cloud at %.3fm, keep %s", dedup_resolution, DedupPolicyName(policy));
+    dedup_enable = true;
+    dedup_pub = node.advertise<livox_driver_core::DedupStats>(topic + "_accumulated/dedup", 1);
+  }
+}
+
+static void CompactInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  std::string compact_format_name;
+  private_node.param("compact_format", compact_format_name, std::string(""));
+  compact_format = CompactFormatFromString(compact_format_name);
+  if (compact_format != kCompactFormatNone) {
+    ROS_INFO("Compact format %s", CompactFormatName(compact_format));
+    compact_pub = node.advertise<sensor_msgs::PointCloud2>(topic + "_compact", PublisherQosQueueSize());
+
+    /* scale of the integer x/y/z fields in meters, latched so that bags record it with the cloud */
+    std_msgs::Float64 scale;
+    scale.data = CompactFormatScale(compact_format);
+    compact_scale_pub = node.advertise<std_msgs::Float64>(topic + "_compact/scale", 1, true);
+    compact_scale_pub.publish(scale);
+    node.setParam(topic + "_compact/scale", scale.data);
+  }
+}
+
+static void CompressInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  private_node.param("compress", compress_enable, false);
+  if (compress_enable) {
+    ROS_INFO("Compress format %s", LIVOX_CODEC_FORMAT);
+    compress_buffer.resize(LivoxCodecMaxEncodedSize(POINTS_PER_FRAME, LIVOX_CODEC_BLOCK_POINTS));
+    compressed_pub = node.advertise<livox_driver_core::CompressedCloud>(topic + "_compressed",
+                                                                        PublisherQosQueueSize());
+  }
+}
+
+static void ShmInit(ros::NodeHandle &private_node, const std::string &topic) {
+  private_node.param("shm_enable", shm_enable, false);
+  private_node.param("shm_slots", shm_slots, SHM_SLOTS_DEFAULT);
+  if (shm_slots <= 0 || (shm_slots & (shm_slots - 1))) {
+    ROS_WARN("shm_slots %d is not 2^n, use %d", shm_slots, SHM_SLOTS_DEFAULT);
+    shm_slots = SHM_SLOTS_DEFAULT;
+  }
+
+  /* livox/lidar -> /livox_lidar */
+  shm_prefix = "/livox_" + topic.substr(topic.find_last_of('/') + 1);
+}
+
+static void RangeImageOutputInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  private_node.param("range_image_enable", range_image_enable, false);
+  if (!range_image_enable) {
+    return;
+  }
+
+  double azimuth_min, azimuth_max, elevation_min, elevation_max;
+  int cols, rows;
+  private_node.param("range_image_azimuth_min", azimuth_min, -RANGE_IMAGE_FOV_DEFAULT / 2);
+  private_node.param("range_image_azimuth_max", azimuth_max, RANGE_IMAGE_FOV_DEFAULT / 2);
+  private_node.param("range_image_elevation_min", elevation_min, -RANGE_IMAGE_FOV_DEFAULT / 2);
+  private_node.param("range_image_elevation_max", elevation_max, RANGE_IMAGE_FOV_DEFAULT / 2);
+  private_node.param("range_image_cols", cols, RANGE_IMAGE_SIZE_DEFAULT);
+  private_node.param("range_image_rows", rows, RANGE_IMAGE_SIZE_DEFAULT);
+
+  if ((azimuth_max <= azimuth_min) || (elevation_max <= elevation_min) || (cols <= 0) || (rows <= 0)) {
+    ROS_WARN("Invalid range image config, range image disabled");
+    range_image_enable = false;
+    return;
+  }
+
+  RangeImageConfig config;
+  config.azimuth_min = azimuth_min * M_PI / 180.0;
+  config.azimuth_max = azimuth_max * M_PI / 180.0;
+  config.elevation_min = elevation_min * M_PI / 180.0;
+  config.elevation_max = elevation_max * M_PI / 180.0;
+  config.cols = cols;
+  config.rows = rows;
+  RangeImageInit(&range_image, config);
+
+  ROS_INFO("Range image %dx%d, azimuth %.1f~%.1f, elevation %.1f~%.1f", cols, rows,
+           azimuth_min, azimuth_max, elevation_min, elevation_max);
+  range_image_pub = node.advertise<sensor_msgs::Image>(topic + "_range_image/range", 1);
+  intensity_image_pub = node.advertise<sensor_msgs::Image>(topic + "_range_image/intensity", 1);
+  count_image_pub = node.advertise<sensor_msgs::Image>(topic + "_range_image/count", 1);
+}
+
+static void GroundSegmentOutputInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  private_node.param("ground_enable", ground_enable, false);
+  if (!ground_enable) {
+    return;
+  }
+
+  double cell_size, range, sensor_height, height_tolerance, thickness;
+  private_node.param("ground_cell_size", cell_size, GROUND_CELL_SIZE_DEFAULT);
+  private_node.param("ground_range", range, GROUND_RANGE_DEFAULT);
+  private_node.param("ground_sensor_height", sensor_height, GROUND_SENSOR_HEIGHT_DEFAULT);
+  private_node.param("ground_height_tolerance", height_tolerance, GROUND_HEIGHT_TOLERANCE_DEFAULT);
+  private_node.param("ground_thickness", thickness, GROUND_THICKNESS_DEFAULT);
+
+  if ((cell_size <= 0) || (range <= 0) || (height_tolerance < 0) || (thickness < 0)) {
+    ROS_WARN("Invalid ground segmentation config, ground segmentation disabled");
+    ground_enable = false;
+    return;
+  }
+
+  GroundSegmentConfig config;
+  config.cell_size = cell_size;
+  config.range = range;
+  config.sensor_height = sensor_height;
+  config.height_tolerance = height_tolerance;
+  config.thickness = thickness;
+  GroundSegmentInit(&ground_segment, config);
+
+  /* livox/lidar -> livox/ground, livox/obstacles */
+  std::string prefix = topic.substr(0, topic.find_last_of('/') + 1);
+  ROS_INFO("Ground segmentation cell %.2fm range %.1fm, ground %.2f+-%.2fm", cell_size, range,
+           -sensor_height, height_tolerance);
+  ground_pub = node.advertise<sensor_msgs::PointCloud2>(prefix + "ground", PublisherQosQueueSize());
+  obstacles_pub = node.advertise<sensor_msgs::PointCloud2>(prefix + "obstacles", PublisherQosQueueSize());
+}
+
+static void VoxelMapOutputInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  private_node.param("map_enable", map_enable, false);
+  if (!map_enable) {
+    return;
+  }
+
+  double voxel_size, publish_period;
+  int max_voxels;
+  private_node.param("map_voxel_size", voxel_size, MAP_VOXEL_SIZE_DEFAULT);
+  private_node.param("map_max_voxels", max_voxels, MAP_MAX_VOXELS_DEFAULT);
+  private_node.param("map_publish_period", publish_period, MAP_PUBLISH_PERIOD_DEFAULT);
+  private_node.param("map_save_path", map_save_path, std::string(MAP_SAVE_PATH_DEFAULT));
+
+  if ((voxel_size < 0.01) || (max_voxels <= 0) || (publish_period <= 0)) {
+    ROS_WARN("Invalid voxel map config, voxel map disabled");
+    map_enable = false;
+    return;
+  }
+
+  VoxelMapInit(&voxel_map, voxel_size, max_voxels);
+  map_publish_period = ros::Duration(publish_period);
+
+  ROS_INFO("Voxel map %.3fm voxels, at most %d, %lu MB", voxel_size, max_voxels,
+           (unsigned long)(voxel_map.cells.size() * sizeof(VoxelMapCell) >> 20));
+  map_pub = node.advertise<sensor_msgs::PointCloud2>(topic + "_map", 1, true);
+  save_map_srv = private_node.advertiseService("save_map", OnSaveMap);
+}
+
+static void HeightGridOutputInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  private_node.param("grid_enable", grid_enable, false);
+  if (!grid_enable) {
+    return;
+  }
+
+  double resolution, size, obstacle_height, decay, rate;
+  private_node.param("grid_frame", grid_frame, std::string("livox_frame"));
+  private_node.param("grid_resolution", resolution, GRID_RESOLUTION_DEFAULT);
+  private_node.param("grid_size", size, GRID_SIZE_DEFAULT);
+  private_node.param("grid_obstacle_height", obstacle_height, GRID_OBSTACLE_HEIGHT_DEFAULT);
+  private_node.param("grid_decay", decay, GRID_DECAY_DEFAULT);
+  private_node.param("grid_rate", rate, GRID_RATE_DEFAULT);
+
+  if ((resolution <= 0) || (size < resolution) || (decay <= 0) || (rate <= 0)) {
+    ROS_WARN("Invalid height grid config, height grid disabled");
+    grid_enable = false;
+    return;
+  }
+
+  HeightGridInit(&height_grid, resolution, (uint32_t)(size / resolution), obstacle_height,
+                 (uint32_t)(decay * 1000));
+  grid_period = ros::Duration(1.0 / rate);
+  grid_start_time = ros::Time::now();
+
+  /* in livox_frame the window stays on the lidar, no transform needed */
+  if (grid_frame != "livox_frame") {
+    grid_tf_listener = new tf::TransformListener;
+  }
+
+  ROS_INFO("Height grid %ux%u cells of %.2fm in %s at %.1fhz", height_grid.size, height_grid.size,
+           resolution, grid_frame.c_str(), rate);
+  grid_pub = node.advertise<nav_msgs::OccupancyGrid>(topic + "_grid", 1);
+  grid_elevation_pub = node.advertise<sensor_msgs::Image>(topic + "_grid/elevation", 1);
+}
+
+void OutputsInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic,
+                 uint32_t point_step, const std::vector<sensor_msgs::PointField> *fields) {
+  output_point_step = point_step;
+  output_fields = fields;
+
+  AccumulateInit(node, private_node, topic, point_step, fields);
+  CompactInit(node, private_node, topic);
+  CompressInit(node, private_node, topic);
+  ShmInit(private_node, topic);
+  RangeImageOutputInit(node, private_node, topic);
+  GroundSegmentOutputInit(node, private_node, topic);
+  VoxelMapOutputInit(node, private_node, topic);
+  HeightGridOutputInit(node, private_node, topic);
+}
+
+void OutputsUninit(void) {
+  if (map_enable) {
+    std::string message;
+    SaveVoxelMap(&message);
+  }
+
+  for (int i = 0; i < kMaxLidarCount; i++) {
+    if (shm_rings[i].base) {
+      ShmRingDestroy(&shm_rings[i]);
+    }
+  }
+
+  delete grid_tf_listener;
+  grid_tf_listener = NULL;
+}
+
+void OutputsReleaseHandle(uint8_t handle) {
+  if (shm_rings[handle].base) {
+    ShmRingDestroy(&shm_rings[handle]);
+  }
+}
+
+OutputsNeed OutputsFrameNeed(void) {
+  OutputsWanted *wanted = &outputs_wanted;
+  wanted->compact = (compact_format != kCompactFormatNone) && compact_pub.getNumSubscribers();
+  wanted->compressed = compress_enable && compressed_pub.getNumSubscribers();
+  wanted->range_image = range_image_enable && (range_image_pub.getNumSubscribers() ||
+                        intensity_image_pub.getNumSubscribers() || count_image_pub.getNumSubscribers());
+  wanted->ground = ground_enable && (ground_pub.getNumSubscribers() || obstacles_pub.getNumSubscribers());
+
+  if (accumulate_enable || wanted->ground) {
+    return kOutputsNeedCloud;
+  }
+  /* shared memory readers are not known, the map is saved whether or not anyone watches it */
+  if (wanted->compact || wanted->compressed || wanted->range_image || grid_enable || shm_enable || map_enable) {
+    return kOutputsNeedRaw;
+  }
+  return kOutputsNeedNone;
+}
+
+/* segment is NULL for a frame that was not converted, stamp is the time of its first point */
+static void PublishFrame(uint8_t handle, const LivoxRawPoint *raw_points, uint32_t num,
+                         const FrameSegment *segment, const ros::Time &stamp) {
+  const OutputsWanted *wanted = &outputs_wanted;
+  if (wanted->range_image) {
+    PublishRangeImage(raw_points, num, stamp);
+  }
+
+  if (segment && wanted->ground) {
+    PublishGroundSegments(raw_points, num, *segment);
+  }
+
+  if (wanted->compact) {
+    PublishCompactCloud(raw_points, num, stamp);
+  }
+
+  if (wanted->compressed) {
+    PublishCompressedCloud(raw_points, num, stamp);
+  }
+
+  if (shm_enable) {
+    WriteShmRing(handle, raw_points, num, stamp);
+  }
+
+  if (map_enable) {
+    VoxelMapInsert(&voxel_map, raw_points, num);
+  }
+
+  if (grid_enable) {
+    UpdateHeightGrid(raw_points, num, stamp);
+  }
+
+  if (segment && accumulate_enable) {
+    FrameWindowPush(&frame_window, *segment);
+  }
+}
+
+void OutputsPublishFrame(uint8_t handle, const LivoxRawPoint *raw_points, uint32_t num,
+                         const FrameSegment &segment) {
+  PublishFrame(handle, raw_points, num, &segment, segment.stamp);
+}
+
+void OutputsPublishRawFrame(uint8_t handle, const LivoxRawPoint *raw_points, uint32_t num,
+                            const ros::Time &stamp) {
+  PublishFrame(handle, raw_points, num, NULL, stamp);
+}
+
+void OutputsPoll(void) {
+  if (accumulate_enable) {
+    PublishAccumulatedCloud();
+  }
+
+  if (map_enable) {
+    PublishVoxelMap();
+  }
+
+  if (grid_enable) {
+    PublishHeightGrid();
+  }
+}
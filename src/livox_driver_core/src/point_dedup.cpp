@@ -0,0 +1,178 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+#include <string.h>
+
+#include "livox_driver_core/point_dedup.h"
+#include "livox_driver_core/voxel_key.h"
+
+DedupPolicy DedupPolicyFromString(const std::string &name) {
+  return (name == "closest") ? kDedupKeepClosest : kDedupKeepReflectivity;
+}
+
+const char *DedupPolicyName(DedupPolicy policy) {
+  return (policy == kDedupKeepClosest) ? "closest" : "reflectivity";
+}
+
+static const sensor_msgs::PointField *FindField(const std::vector<sensor_msgs::PointField> *fields,
+                                                const char *name) {
+  for (size_t i = 0; i < fields->size(); ++i) {
+    if ((*fields)[i].name == name) {
+      return &(*fields)[i];
+    }
+  }
+  return NULL;
+}
+
+bool PointDedupInit(PointDedup *dedup, float resolution, DedupPolicy policy, uint32_t point_step,
+                    const std::vector<sensor_msgs::PointField> *fields) {
+  const sensor_msgs::PointField *x = FindField(fields, "x");
+  const sensor_msgs::PointField *y = FindField(fields, "y");
+  const sensor_msgs::PointField *z = FindField(fields, "z");
+  if (!x || !y || !z || (y->offset != x->offset + 4) || (z->offset != x->offset + 8) ||
+      ((x->datatype != sensor_msgs::PointField::FLOAT32) && (x->datatype != sensor_msgs::PointField::INT32))) {
+    return false;
+  }
+
+  const sensor_msgs::PointField *score = FindField(fields, "intensity");
+  score = score ? score : FindField(fields, "reflectivity");
+
+  dedup->resolution = resolution;
+  dedup->policy = policy;
+  dedup->point_step = point_step;
+  dedup->xyz_offset = x->offset;
+  dedup->xyz_mm = (x->datatype == sensor_msgs::PointField::INT32);
+  dedup->score_offset = score ? (int32_t)score->offset : -1;
+  dedup->score_datatype = score ? score->datatype : 0;
+  dedup->slot_bits = 0;
+  dedup->frame = 0;
+  return true;
+}
+
+static inline float PointScore(const PointDedup *dedup, const uint8_t *point, float x, float y, float z) {
+  if (dedup->policy == kDedupKeepClosest) {
+    return -(x * x + y * y + z * z);
+  }
+  if (dedup->score_offset < 0) {
+    return 0.0f;
+  }
+
+  if (dedup->score_datatype == sensor_msgs::PointField::FLOAT32) {
+    float value;
+    memcpy(&value, point + dedup->score_offset, sizeof(value));
+    return value;
+  }
+  return (float)point[dedup->score_offset];
+}
+
+void PointDedupRun(PointDedup *dedup, const std::vector<FrameSegment> &segments, std::vector<uint32_t> *kept) {
+  uint32_t num = 0;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    num += segments[i].point_count;
+  }
+
+  kept->clear();
+  if (!num) {
+    return;
+  }
+
+  /* keep the table at most half full */
+  uint32_t bits = 4;
+  while ((1u << bits) < 2 * num) {
+    bits++;
+  }
+  if (bits > dedup->slot_bits) {
+    PointDedupSlot empty = { 0, 0, 0, 0.0f };
+    dedup->slot_bits = bits;
+    dedup->slots.assign(1u << bits, empty);
+    dedup->frame = 0;
+  }
+
+  /* 0 marks slots never written */
+  if (++dedup->frame == 0) {
+    for (size_t i = 0; i < dedup->slots.size(); ++i) {
+      dedup->slots[i].frame = 0;
+    }
+    dedup->frame = 1;
+  }
+
+  PointDedupSlot *slots = &dedup->slots[0];
+  uint32_t mask = (1u << dedup->slot_bits) - 1;
+  float scale = dedup->xyz_mm ? 0.001f : 1.0f;
+  float inv_resolution = 1.0f / dedup->resolution;
+  uint32_t index = 0;
+
+  dedup->occupied.clear();
+  for (size_t s = 0; s < segments.size(); ++s) {
+    const uint8_t *point = segments[s].data;
+    for (uint32_t i = 0; i < segments[s].point_count; ++i, ++index, point += dedup->point_step) {
+      float x, y, z;
+      if (dedup->xyz_mm) {
+        int32_t xyz[3];
+        memcpy(xyz, point + dedup->xyz_offset, sizeof(xyz));
+        x = xyz[0] * scale;
+        y = xyz[1] * scale;
+        z = xyz[2] * scale;
+      } else {
+        float xyz[3];
+        memcpy(xyz, point + dedup->xyz_offset, sizeof(xyz));
+        x = xyz[0];
+        y = xyz[1];
+        z = xyz[2];
+      }
+
+      uint64_t key = VoxelKey((int32_t)floorf(x * inv_resolution), (int32_t)floorf(y * inv_resolution),
+                              (int32_t)floorf(z * inv_resolution));
+      uint32_t slot = VoxelKeyHash(key, dedup->slot_bits);
+      while ((slots[slot].frame == dedup->frame) && (slots[slot].key != key)) {
+        slot = (slot + 1) & mask;
+      }
+
+      float score = PointScore(dedup, point, x, y, z);
+      if (slots[slot].frame != dedup->frame) {
+        slots[slot].frame = dedup->frame;
+        slots[slot].key = key;
+        slots[slot].point = index;
+        slots[slot].score = score;
+        dedup->occupied.push_back(slot);
+      } else if (score > slots[slot].score) {
+        slots[slot].point = index;
+        slots[slot].score = score;
+      }
+    }
+  }
+
+  /* ascending order without sorting, mark the kept points and collect them */
+  dedup->keep.assign(num, 0);
+  for (size_t i = 0; i < dedup->occupied.size(); ++i) {
+    dedup->keep[slots[dedup->occupied[i]].point] = 1;
+  }
+  kept->reserve(dedup->occupied.size());
+  for (uint32_t i = 0; i < num; ++i) {
+    if (dedup->keep[i]) {
+      kept->push_back(i);
+    }
+  }
+}
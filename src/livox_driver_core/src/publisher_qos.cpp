@@ -0,0 +1,120 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <map>
+
+#include <rosgraph_msgs/TopicStatistics.h>
+
+#include "livox_driver_core/publisher_qos.h"
+#include "livox_driver_core/SubscriberQos.h"
+
+#define PUBLISH_QUEUE_SIZE_DEFAULT      (4)       // frames per subscriber
+#define SLOW_SUBSCRIBER_AGE_DEFAULT     (0.5)     // s
+
+typedef struct {
+  uint64_t delivered_total;
+  uint64_t gaps_total;
+  bool slow;
+} SubscriberAccount;
+
+static uint32_t publish_queue_size = PUBLISH_QUEUE_SIZE_DEFAULT;
+static double slow_subscriber_age = SLOW_SUBSCRIBER_AGE_DEFAULT;
+static std::string node_name;
+static ros::Subscriber statistics_sub;
+static ros::Publisher qos_pub;
+
+/* by topic and subscriber node */
+static std::map<std::pair<std::string, std::string>, SubscriberAccount> subscriber_accounts;
+
+static void OnTopicStatistics(const rosgraph_msgs::TopicStatistics::ConstPtr &statistics) {
+  if (statistics->node_pub != node_name) {
+    return;
+  }
+
+  SubscriberAccount *account = &subscriber_accounts[std::make_pair(statistics->topic, statistics->node_sub)];
+  /* roscpp counts one dropped message per seq gap, not the frames it spans */
+  uint32_t gaps = (statistics->dropped_msgs > 0) ? statistics->dropped_msgs : 0;
+  double age_mean = statistics->stamp_age_mean.toSec();
+  bool slow = (gaps > 0) || (age_mean > slow_subscriber_age);
+  account->delivered_total += statistics->delivered_msgs;
+  account->gaps_total += gaps;
+
+  if (slow && !account->slow) {
+    ROS_WARN("Subscriber %s of %s is slow, %u seq gaps in %u frames, age %.3fs", statistics->node_sub.c_str(),
+             statistics->topic.c_str(), gaps, (uint32_t)statistics->delivered_msgs, age_mean);
+  } else if (!slow && account->slow) {
+    ROS_INFO("Subscriber %s of %s keeps up again", statistics->node_sub.c_str(), statistics->topic.c_str());
+  }
+  account->slow = slow;
+
+  livox_driver_core::SubscriberQosPtr msg(new livox_driver_core::SubscriberQos);
+  msg->header.stamp = statistics->window_stop;
+  msg->topic = statistics->topic;
+  msg->subscriber = statistics->node_sub;
+  msg->window = (statistics->window_stop - statistics->window_start).toSec();
+  msg->delivered = statistics->delivered_msgs;
+  msg->gaps = gaps;
+  msg->delivered_total = account->delivered_total;
+  msg->gaps_total = account->gaps_total;
+  msg->stamp_age_mean = age_mean;
+  msg->stamp_age_max = statistics->stamp_age_max.toSec();
+  msg->slow = slow;
+  qos_pub.publish(msg);
+}
+
+void PublisherQosInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  std::string qos;
+  int queue_size;
+  private_node.param("publish_qos", qos, std::string("keep_last"));
+  private_node.param("publish_queue_size", queue_size, PUBLISH_QUEUE_SIZE_DEFAULT);
+  private_node.param("slow_subscriber_age", slow_subscriber_age, SLOW_SUBSCRIBER_AGE_DEFAULT);
+  if (queue_size <= 0) {
+    ROS_WARN("publish_queue_size %d is not positive, use %d", queue_size, PUBLISH_QUEUE_SIZE_DEFAULT);
+    queue_size = PUBLISH_QUEUE_SIZE_DEFAULT;
+  }
+
+  if (qos == "latest") {
+    publish_queue_size = 1;
+  } else {
+    if (qos != "keep_last") {
+      ROS_WARN("Unknown publish_qos %s, use keep_last", qos.c_str());
+    }
+    publish_queue_size = queue_size;
+  }
+  ROS_INFO("Publish queue %u frames per subscriber", publish_queue_size);
+
+  bool statistics_enable = false;
+  ros::param::get("/enable_statistics", statistics_enable);
+  if (!statistics_enable) {
+    ROS_INFO("Slow subscribers are reported once /enable_statistics is set before they start");
+  }
+
+  node_name = ros::this_node::getName();
+  qos_pub = node.advertise<livox_driver_core::SubscriberQos>(topic + "_qos", 16);
+  statistics_sub = node.subscribe("/statistics", 64, OnTopicStatistics);
+}
+
+uint32_t PublisherQosQueueSize(void) {
+  return publish_queue_size;
+}
@@ -0,0 +1,140 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "livox_driver_core/range_image.h"
+
+#define HALF_PI                         (1.57079632679f)
+#define PI                              (3.14159265359f)
+
+/*
+ * Branch free atan2, max error about 1e-5 rad. Written with selects only
+ * so that the loop in RangeImageProject() is vectorized by the compiler.
+ */
+static inline float FastAtan2(float y, float x) {
+  float abs_x = fabsf(x);
+  float abs_y = fabsf(y);
+  float max_xy = (abs_x > abs_y) ? abs_x : abs_y;
+  float min_xy = (abs_x > abs_y) ? abs_y : abs_x;
+  float a = min_xy / (max_xy + FLT_MIN);
+  float s = a * a;
+
+  float r = ((((-0.0117212f * s + 0.05265332f) * s - 0.11643287f) * s + 0.19354346f) * s - 0.33262347f) * s * a
+            + 0.99997726f * a;
+  r = (abs_y > abs_x) ? (HALF_PI - r) : r;
+  r = (x < 0.0f) ? (PI - r) : r;
+  return (y < 0.0f) ? -r : r;
+}
+
+/* asin(z / |p|) evaluated as atan2(z, |p.xy|), which needs no domain clamp */
+static inline float FastElevation(float x, float y, float z) {
+  return FastAtan2(z, sqrtf(x * x + y * y));
+}
+
+void RangeImageInit(RangeImage *image, const RangeImageConfig &config) {
+  uint32_t cells = config.cols * config.rows;
+
+  image->config = config;
+  image->range.assign(cells, 0.0f);
+  image->intensity.assign(cells, 0);
+  image->count.assign(cells, 0);
+}
+
+void RangeImageProject(RangeImage *image, const LivoxRawPoint *points, uint32_t num) {
+  const RangeImageConfig &config = image->config;
+
+  image->x.resize(num);
+  image->y.resize(num);
+  image->z.resize(num);
+  image->cell.resize(num);
+  image->point_range.resize(num);
+  std::fill(image->range.begin(), image->range.end(), 0.0f);
+  std::fill(image->intensity.begin(), image->intensity.end(), 0);
+  std::fill(image->count.begin(), image->count.end(), 0);
+  if (!num) {
+    return;
+  }
+
+  float *x = &image->x[0];
+  float *y = &image->y[0];
+  float *z = &image->z[0];
+  int32_t *cell = &image->cell[0];
+  float *point_range = &image->point_range[0];
+
+  float azimuth_max = config.azimuth_max;
+  float elevation_max = config.elevation_max;
+  float col_scale = config.cols / (config.azimuth_max - config.azimuth_min);
+  float row_scale = config.rows / (config.elevation_max - config.elevation_min);
+  float cols = (float)config.cols;
+  float rows = (float)config.rows;
+  int32_t stride = (int32_t)config.cols;
+
+  /* packed raw points to meters, split per axis for the pass below */
+  for (uint32_t i = 0; i < num; ++i) {
+    x[i] = points[i].x / 1000.0f;
+    y[i] = points[i].y / 1000.0f;
+    z[i] = points[i].z / 1000.0f;
+  }
+
+  /* vectorized pass: angles, range and cell index of every point */
+  for (uint32_t i = 0; i < num; ++i) {
+    float azimuth = FastAtan2(y[i], x[i]);
+    float elevation = FastElevation(x[i], y[i], z[i]);
+    float col = (azimuth_max - azimuth) * col_scale;
+    float row = (elevation_max - elevation) * row_scale;
+    int32_t inside = (col >= 0.0f) & (col < cols) & (row >= 0.0f) & (row < rows);
+
+    /* out of range float to int conversion is undefined, convert 0 for points outside */
+    col = inside ? col : 0.0f;
+    row = inside ? row : 0.0f;
+    int32_t index = (int32_t)row * stride + (int32_t)col;
+
+    point_range[i] = sqrtf(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+    cell[i] = inside ? index : -1;
+  }
+
+  /* scalar pass: scatter into the grid */
+  float *range = &image->range[0];
+  uint8_t *intensity = &image->intensity[0];
+  uint16_t *count = &image->count[0];
+  for (uint32_t i = 0; i < num; ++i) {
+    int32_t c = cell[i];
+    if ((c < 0) || (point_range[i] <= 0.0f)) {
+      continue;
+    }
+
+    if ((count[c] == 0) || (point_range[i] < range[c])) {
+      range[c] = point_range[i];
+      intensity[c] = points[i].reflectivity;
+    }
+    if (count[c] < UINT16_MAX) {
+      count[c]++;
+    }
+  }
+}
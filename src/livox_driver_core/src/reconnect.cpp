@@ -0,0 +1,176 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "livox_driver_core/reconnect.h"
+#include "livox_driver_core/Reconnect.h"
+
+#define RECONNECT_BACKOFF_MIN_DEFAULT   (0.1)     // s
+#define RECONNECT_BACKOFF_MAX_DEFAULT   (2.0)     // s
+
+typedef enum {
+  kRingPolicyKeep = 0,            // points queued before the disconnect are published
+  kRingPolicyFlush = 1,           // points queued before the disconnect are dropped
+} RingPolicy;
+
+static StartSamplingFunc start_sampling_func = NULL;
+static uint64_t backoff_min_ns;
+static uint64_t backoff_max_ns;
+static RingPolicy ring_policy = kRingPolicyFlush;
+static ros::Publisher reconnect_pub;
+
+/* device of each data callback handle, set on connect */
+static DeviceItem *handle_devices[kMaxLidarCount];
+
+static uint64_t Backoff(uint32_t attempts) {
+  uint64_t backoff = backoff_min_ns;
+  while (attempts-- > 1 && backoff < backoff_max_ns) {
+    backoff <<= 1;
+  }
+  return (backoff < backoff_max_ns) ? backoff : backoff_max_ns;
+}
+
+void ReconnectInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic,
+                   StartSamplingFunc start_sampling) {
+  double backoff_min;
+  double backoff_max;
+  std::string policy;
+  private_node.param("reconnect_backoff_min", backoff_min, RECONNECT_BACKOFF_MIN_DEFAULT);
+  private_node.param("reconnect_backoff_max", backoff_max, RECONNECT_BACKOFF_MAX_DEFAULT);
+  private_node.param("reconnect_ring_policy", policy, std::string("flush"));
+  if ((backoff_min <= 0) || (backoff_max < backoff_min)) {
+    ROS_WARN("Invalid reconnect backoff %.3f~%.3fs, use %.3f~%.3fs", backoff_min, backoff_max,
+             RECONNECT_BACKOFF_MIN_DEFAULT, RECONNECT_BACKOFF_MAX_DEFAULT);
+    backoff_min = RECONNECT_BACKOFF_MIN_DEFAULT;
+    backoff_max = RECONNECT_BACKOFF_MAX_DEFAULT;
+  }
+  if (policy == "keep") {
+    ring_policy = kRingPolicyKeep;
+  } else if (policy != "flush") {
+    ROS_WARN("Unknown reconnect_ring_policy %s, use flush", policy.c_str());
+  }
+
+  backoff_min_ns = (uint64_t)(backoff_min * 1e9);
+  backoff_max_ns = (uint64_t)(backoff_max * 1e9);
+  start_sampling_func = start_sampling;
+  ROS_INFO("Reconnect backoff %.3f~%.3fs, %s ring", backoff_min, backoff_max,
+           (ring_policy == kRingPolicyFlush) ? "flush" : "keep");
+
+  reconnect_pub = node.advertise<livox_driver_core::Reconnect>(topic + "_reconnect", 8);
+}
+
+void ReconnectOnDisconnect(DeviceItem *device) {
+  DeviceReconnect *reconnect = &device->reconnect;
+  reconnect->disconnect_ns = MonotonicNs();
+  reconnect->flushed_points = 0;
+  __atomic_store_n(&reconnect->flush_pending, (ring_policy == kRingPolicyFlush), __ATOMIC_RELAXED);
+  __atomic_store_n(&reconnect->stage, kReconnectDisconnected, __ATOMIC_RELEASE);
+}
+
+void ReconnectOnConnect(DeviceItem *device) {
+  DeviceReconnect *reconnect = &device->reconnect;
+  uint64_t now = MonotonicNs();
+  reconnect->connect_ns = now;
+  reconnect->attempts = 0;
+  reconnect->next_attempt_ns = now;
+  if (device->handle < kMaxLidarCount) {
+    handle_devices[device->handle] = device;
+  }
+  if (__atomic_load_n(&reconnect->stage, __ATOMIC_ACQUIRE) == kReconnectDisconnected) {
+    __atomic_store_n(&reconnect->stage, kReconnectConnected, __ATOMIC_RELEASE);
+  }
+}
+
+void ReconnectOnPacket(uint8_t handle) {
+  DeviceItem *device = handle_devices[handle];
+  if (!device || (__atomic_load_n(&device->reconnect.stage, __ATOMIC_RELAXED) != kReconnectConnected)) {
+    return;
+  }
+
+  device->reconnect.first_point_ns = MonotonicNs();
+  __atomic_store_n(&device->reconnect.stage, kReconnectFirstPoint, __ATOMIC_RELEASE);
+}
+
+/* drop the points queued before the disconnect, the ros thread is the only reader */
+static uint32_t FlushQueues(DeviceItem *device) {
+  uint32_t flushed = 0;
+  for (int i = 0; i < kMaxLidarCount; i++) {
+    /* the lidars behind a hub share its connection */
+    if ((device->info.type == kDeviceTypeHub) || (i == device->handle)) {
+      PointCloudQueue *queue = &point_cloud_queue_pool[i];
+      uint32_t wr_idx = queue->wr_idx;
+      flushed += wr_idx - queue->rd_idx;
+      queue->rd_idx = wr_idx;
+    }
+  }
+  return flushed;
+}
+
+static void PublishReconnect(DeviceItem *device) {
+  DeviceReconnect *reconnect = &device->reconnect;
+  livox_driver_core::ReconnectPtr msg(new livox_driver_core::Reconnect);
+  msg->header.stamp = ros::Time::now();
+  msg->header.frame_id = "livox_frame";
+  msg->handle = device->handle;
+  msg->broadcast_code = device->info.broadcast_code;
+  msg->outage = (reconnect->first_point_ns - reconnect->disconnect_ns) / 1e9;
+  msg->time_to_first_point = (reconnect->first_point_ns - reconnect->connect_ns) / 1e9;
+  msg->sampling_attempts = reconnect->attempts;
+  msg->flushed_points = reconnect->flushed_points;
+
+  ROS_INFO("%s reconnected, outage %.3fs, first point %.3fs after connect, %u attempts",
+           msg->broadcast_code.c_str(), msg->outage, msg->time_to_first_point, msg->sampling_attempts);
+  reconnect_pub.publish(msg);
+}
+
+static void PollDevice(DeviceItem *device, uint64_t now) {
+  DeviceReconnect *reconnect = &device->reconnect;
+
+  if (__atomic_load_n(&reconnect->flush_pending, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&reconnect->flush_pending, 0, __ATOMIC_RELAXED);
+    reconnect->flushed_points += FlushQueues(device);
+  }
+
+  /* the only place the start command is sent from, the sdk thread only moves the device to connect */
+  if ((__atomic_load_n(&device->device_state, __ATOMIC_ACQUIRE) == kDeviceStateConnect) &&
+      (device->info.state == kLidarStateNormal) && (now >= reconnect->next_attempt_ns) && start_sampling_func) {
+    reconnect->attempts++;
+    reconnect->next_attempt_ns = now + Backoff(reconnect->attempts);
+    ROS_INFO("%s start sampling, attempt %u", device->info.broadcast_code, reconnect->attempts);
+    start_sampling_func(device);
+  }
+
+  if (__atomic_load_n(&reconnect->stage, __ATOMIC_ACQUIRE) == kReconnectFirstPoint) {
+    PublishReconnect(device);
+    __atomic_store_n(&reconnect->stage, kReconnectNone, __ATOMIC_RELAXED);
+  }
+}
+
+void ReconnectPoll(void) {
+  uint64_t now = MonotonicNs();
+  for (int i = 0; i < kMaxLidarCount; i++) {
+    if (handle_devices[i]) {
+      PollDevice(handle_devices[i], now);
+    }
+  }
+}
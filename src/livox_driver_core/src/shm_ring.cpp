@@ -0,0 +1,231 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "livox_driver_core/shm_ring.h"
+
+static inline ShmRingHeader* RingHeader(const ShmRing *ring) {
+  return (ShmRingHeader *)ring->base;
+}
+
+static inline ShmFrameHeader* RingSlot(const ShmRing *ring, uint64_t frame_seq) {
+  ShmRingHeader *header = RingHeader(ring);
+  uint32_t idx = (uint32_t)frame_seq & (header->slot_count - 1);
+  return (ShmFrameHeader *)(ring->base + sizeof(ShmRingHeader) + (size_t)idx * header->slot_size);
+}
+
+static int Futex(volatile uint32_t *addr, int op, uint32_t val, const struct timespec *timeout) {
+  return syscall(SYS_futex, addr, op, val, timeout, NULL, 0);
+}
+
+static int64_t NowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int ShmRingCreate(ShmRing *ring, const char *name, uint32_t handle, uint32_t slot_count, uint32_t slot_points) {
+  if ((slot_count == 0) || (slot_count & (slot_count - 1))) {
+    return -1;
+  }
+
+  uint32_t slot_size = sizeof(ShmFrameHeader) + slot_points * sizeof(ShmPoint);
+  size_t size = sizeof(ShmRingHeader) + (size_t)slot_count * slot_size;
+
+  memset(ring, 0, sizeof(*ring));
+  snprintf(ring->name, sizeof(ring->name), "%s", name);
+  ring->fd = shm_open(ring->name, O_CREAT | O_RDWR, 0644);
+  if (ring->fd < 0) {
+    return -1;
+  }
+  if (ftruncate(ring->fd, size) < 0) {
+    close(ring->fd);
+    shm_unlink(ring->name);
+    return -1;
+  }
+
+  void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+  if (base == MAP_FAILED) {
+    close(ring->fd);
+    shm_unlink(ring->name);
+    return -1;
+  }
+
+  ring->base = (uint8_t *)base;
+  ring->size = size;
+  ring->owner = 1;
+  memset(ring->base, 0, size);
+
+  ShmRingHeader *header = RingHeader(ring);
+  header->version = SHM_RING_VERSION;
+  header->handle = handle;
+  header->slot_count = slot_count;
+  header->slot_points = slot_points;
+  header->slot_size = slot_size;
+  /* readers check magic last */
+  __atomic_store_n(&header->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+  return 0;
+}
+
+ShmPoint* ShmRingBeginWrite(ShmRing *ring) {
+  ShmRingHeader *header = RingHeader(ring);
+  ShmFrameHeader *frame = RingSlot(ring, header->write_seq);
+
+  __atomic_store_n(&frame->lock, frame->lock + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  return (ShmPoint *)(frame + 1);
+}
+
+void ShmRingEndWrite(ShmRing *ring, uint32_t point_count, uint64_t stamp_ns) {
+  ShmRingHeader *header = RingHeader(ring);
+  uint64_t frame_seq = header->write_seq;
+  ShmFrameHeader *frame = RingSlot(ring, frame_seq);
+
+  frame->point_count = (point_count < header->slot_points) ? point_count : header->slot_points;
+  frame->stamp_ns = stamp_ns;
+  frame->frame_seq = frame_seq;
+  __atomic_store_n(&frame->lock, frame->lock + 1, __ATOMIC_RELEASE);
+
+  __atomic_store_n(&header->write_seq, frame_seq + 1, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&header->futex, 1, __ATOMIC_RELEASE);
+  Futex(&header->futex, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+void ShmRingDestroy(ShmRing *ring) {
+  if (ring->base) {
+    munmap(ring->base, ring->size);
+  }
+  if (ring->fd >= 0) {
+    close(ring->fd);
+  }
+  if (ring->owner) {
+    shm_unlink(ring->name);
+  }
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+int ShmRingOpen(ShmRing *ring, const char *name) {
+  memset(ring, 0, sizeof(*ring));
+  snprintf(ring->name, sizeof(ring->name), "%s", name);
+  ring->fd = shm_open(ring->name, O_RDONLY, 0);
+  if (ring->fd < 0) {
+    return -1;
+  }
+
+  struct stat st;
+  if ((fstat(ring->fd, &st) < 0) || ((size_t)st.st_size < sizeof(ShmRingHeader))) {
+    close(ring->fd);
+    return -1;
+  }
+
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, ring->fd, 0);
+  if (base == MAP_FAILED) {
+    close(ring->fd);
+    return -1;
+  }
+  ring->base = (uint8_t *)base;
+  ring->size = st.st_size;
+
+  ShmRingHeader *header = RingHeader(ring);
+  if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC) || \
+      (header->version != SHM_RING_VERSION) || \
+      (sizeof(ShmRingHeader) + (size_t)header->slot_count * header->slot_size > ring->size)) {
+    ShmRingClose(ring);
+    return -1;
+  }
+
+  return 0;
+}
+
+void ShmRingClose(ShmRing *ring) {
+  ShmRingDestroy(ring);
+}
+
+uint64_t ShmRingWriteSeq(const ShmRing *ring) {
+  return __atomic_load_n(&RingHeader(ring)->write_seq, __ATOMIC_ACQUIRE);
+}
+
+/** Wait until frame frame_seq is written, return 0 when it is, -1 on timeout. */
+int ShmRingWait(ShmRing *ring, uint64_t frame_seq, int timeout_ms) {
+  ShmRingHeader *header = RingHeader(ring);
+  int64_t deadline_ns = NowNs() + (int64_t)timeout_ms * 1000000;
+
+  while (1) {
+    uint32_t futex = __atomic_load_n(&header->futex, __ATOMIC_ACQUIRE);
+    if (ShmRingWriteSeq(ring) > frame_seq) {
+      return 0;
+    }
+
+    /* FUTEX_WAIT takes a relative timeout, wakeups for other frames must not restart it */
+    struct timespec timeout;
+    if (timeout_ms >= 0) {
+      int64_t remain_ns = deadline_ns - NowNs();
+      if (remain_ns <= 0) {
+        return -1;
+      }
+      timeout.tv_sec = remain_ns / 1000000000;
+      timeout.tv_nsec = remain_ns % 1000000000;
+    }
+    if ((Futex(&header->futex, FUTEX_WAIT, futex, (timeout_ms < 0) ? NULL : &timeout) < 0) && \
+        (errno == ETIMEDOUT)) {
+      return (ShmRingWriteSeq(ring) > frame_seq) ? 0 : -1;
+    }
+  }
+}
+
+/** Zero copy view of frame frame_seq, return -1 if it is not in the ring. */
+int ShmRingAcquire(const ShmRing *ring, uint64_t frame_seq, ShmFrameView *view) {
+  ShmFrameHeader *frame = RingSlot(ring, frame_seq);
+
+  uint32_t lock = __atomic_load_n(&frame->lock, __ATOMIC_ACQUIRE);
+  if ((lock & 1) || (frame->frame_seq != frame_seq) || (ShmRingWriteSeq(ring) <= frame_seq)) {
+    return -1;
+  }
+
+  view->frame = frame;
+  view->points = (const ShmPoint *)(frame + 1);
+  view->lock = lock;
+
+  return 0;
+}
+
+/** Call after reading a view, return 0 if the writer did not touch the slot meanwhile. */
+int ShmRingValidate(const ShmFrameView *view) {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return (__atomic_load_n(&view->frame->lock, __ATOMIC_RELAXED) == view->lock) ? 0 : -1;
+}
@@ -0,0 +1,163 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <string.h>
+
+#include "livox_sdk.h"
+
+#include "livox_driver_core/startup.h"
+#include "livox_driver_core/driver_core.h"
+#include "livox_driver_core/Startup.h"
+
+#define STARTUP_TIMEOUT_DEFAULT         (30.0)    // s
+
+typedef struct {
+  volatile uint64_t phase_ns[kStartupPhaseNum];   // since StartupBegin(), 0 until reached
+  char broadcast_code[kBroadcastCodeSize];
+} StartupTimeline;
+
+static uint64_t begin_ns;
+static StartupTimeline timelines[kMaxLidarCount];
+
+static int expected_devices = 0;
+static uint64_t timeout_ns;
+static bool timeout_reported = false;
+static uint32_t published_first_packets = 0;
+static uint64_t ready_ns = 0;
+static ros::Publisher startup_pub;
+
+void StartupBegin(void) {
+  begin_ns = MonotonicNs();
+  memset(timelines, 0, sizeof(timelines));
+}
+
+void StartupInit(ros::NodeHandle &node, ros::NodeHandle &private_node, const std::string &topic) {
+  double timeout;
+  private_node.param("startup_expected_devices", expected_devices, 0);
+  private_node.param("startup_timeout", timeout, STARTUP_TIMEOUT_DEFAULT);
+  timeout_ns = (uint64_t)(timeout * 1e9);
+  if (expected_devices > 0) {
+    ROS_INFO("Wait for %d devices, timeout %.1fs", expected_devices, timeout);
+  }
+
+  startup_pub = node.advertise<livox_driver_core::Startup>(topic + "_startup", 1, true);
+}
+
+void StartupStamp(uint8_t handle, StartupPhase phase) {
+  if (handle >= kMaxLidarCount) {
+    return;
+  }
+
+  uint64_t expected = 0;
+  uint64_t now = MonotonicNs() - begin_ns;
+  __atomic_compare_exchange_n(&timelines[handle].phase_ns[phase], &expected, now ? now : 1, false,
+                              __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+
+void StartupOnBroadcast(uint8_t handle, const char *broadcast_code) {
+  if (handle >= kMaxLidarCount) {
+    return;
+  }
+
+  if (!timelines[handle].phase_ns[kStartupBroadcast]) {
+    strncpy(timelines[handle].broadcast_code, broadcast_code, kBroadcastCodeSize - 1);
+  }
+  StartupStamp(handle, kStartupBroadcast);
+}
+
+void StartupOnPacket(uint8_t handle) {
+  if (!__atomic_load_n(&timelines[handle].phase_ns[kStartupFirstPacket], __ATOMIC_RELAXED)) {
+    StartupStamp(handle, kStartupFirstPacket);
+  }
+}
+
+void StartupOnHubLidar(uint8_t handle, const char *broadcast_code) {
+  if (handle >= kMaxLidarCount) {
+    return;
+  }
+
+  if (!timelines[handle].phase_ns[kStartupConnect]) {
+    strncpy(timelines[handle].broadcast_code, broadcast_code, kBroadcastCodeSize - 1);
+  }
+  StartupStamp(handle, kStartupConnect);
+}
+
+static double PhaseSec(const StartupTimeline *timeline, StartupPhase phase) {
+  return __atomic_load_n(&timeline->phase_ns[phase], __ATOMIC_ACQUIRE) / 1e9;
+}
+
+static void PublishStartup(void) {
+  livox_driver_core::StartupPtr startup(new livox_driver_core::Startup);
+  startup->header.stamp = ros::Time::now();
+  startup->header.frame_id = "livox_frame";
+  startup->expected_devices = expected_devices;
+  startup->ready = (ready_ns != 0);
+  startup->ready_time = ready_ns / 1e9;
+
+  for (int i = 0; i < kMaxLidarCount; i++) {
+    const StartupTimeline *timeline = &timelines[i];
+    if (!timeline->phase_ns[kStartupBroadcast] && !timeline->phase_ns[kStartupConnect] &&
+        !timeline->phase_ns[kStartupFirstPacket]) {
+      continue;
+    }
+
+    livox_driver_core::StartupDevice device;
+    device.handle = i;
+    device.broadcast_code = timeline->broadcast_code;
+    device.broadcast = PhaseSec(timeline, kStartupBroadcast);
+    device.connect = PhaseSec(timeline, kStartupConnect);
+    device.info = PhaseSec(timeline, kStartupInfo);
+    device.sampling = PhaseSec(timeline, kStartupSampling);
+    device.first_packet = PhaseSec(timeline, kStartupFirstPacket);
+    startup->devices.push_back(device);
+  }
+
+  startup_pub.publish(startup);
+}
+
+void StartupPoll(void) {
+  uint32_t first_packets = 0;
+  for (int i = 0; i < kMaxLidarCount; i++) {
+    if (__atomic_load_n(&timelines[i].phase_ns[kStartupFirstPacket], __ATOMIC_ACQUIRE)) {
+      first_packets++;
+    }
+  }
+
+  uint64_t now = MonotonicNs() - begin_ns;
+  if (first_packets == published_first_packets) {
+    if ((expected_devices > 0) && !ready_ns && !timeout_reported && (now > timeout_ns)) {
+      ROS_WARN("Only %u of %d devices sampling after %.1fs", first_packets, expected_devices, now / 1e9);
+      timeout_reported = true;
+    }
+    return;
+  }
+  published_first_packets = first_packets;
+
+  if ((expected_devices > 0) && !ready_ns && (first_packets >= (uint32_t)expected_devices)) {
+    ready_ns = now;
+    ROS_INFO("All %d devices sampling after %.3fs", expected_devices, now / 1e9);
+  }
+
+  PublishStartup();
+}
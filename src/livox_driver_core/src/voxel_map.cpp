@@ -0,0 +1,154 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+#include "livox_driver_core/voxel_map.h"
+#include "livox_driver_core/voxel_key.h"
+#include "livox_driver_core/point_fields.h"
+
+/* layout of the snapshot and the saved map */
+typedef struct {
+  float x;
+  float y;
+  float z;
+  float intensity;
+  uint32_t hits;
+} VoxelMapPoint;
+
+static uint32_t VoxelMapCopy(const VoxelMap *map, VoxelMapPoint *points) {
+  uint32_t count = 0;
+  for (size_t i = 0; i < map->cells.size(); ++i) {
+    const VoxelMapCell *cell = &map->cells[i];
+    if (!cell->hits) {
+      continue;
+    }
+
+    int32_t vx, vy, vz;
+    VoxelKeyDecode(cell->key, &vx, &vy, &vz);
+    points[count].x = (vx + 0.5f) * map->voxel_size;
+    points[count].y = (vy + 0.5f) * map->voxel_size;
+    points[count].z = (vz + 0.5f) * map->voxel_size;
+    points[count].intensity = cell->intensity;
+    points[count].hits = cell->hits;
+    count++;
+  }
+  return count;
+}
+
+void VoxelMapInit(VoxelMap *map, float voxel_size, uint32_t max_voxels) {
+  /* keep the table at most half full */
+  uint32_t bits = 4;
+  while ((1u << bits) < 2 * max_voxels) {
+    bits++;
+  }
+
+  VoxelMapCell empty = { 0, 0, 0.0f };
+  map->voxel_size = voxel_size;
+  map->max_voxels = max_voxels;
+  map->voxel_count = 0;
+  map->point_count = 0;
+  map->dropped_points = 0;
+  map->slot_bits = bits;
+  map->cells.assign(1u << bits, empty);
+}
+
+void VoxelMapInsert(VoxelMap *map, const LivoxRawPoint *points, uint32_t num) {
+  VoxelMapCell *cells = &map->cells[0];
+  uint32_t mask = (1u << map->slot_bits) - 1;
+  float inv_size = 1.0f / (map->voxel_size * 1000.0f);      // raw points are in mm
+
+  for (uint32_t i = 0; i < num; ++i) {
+    if (!points[i].x && !points[i].y && !points[i].z) {
+      continue;
+    }
+
+    uint64_t key = VoxelKey((int32_t)floorf(points[i].x * inv_size), (int32_t)floorf(points[i].y * inv_size),
+                            (int32_t)floorf(points[i].z * inv_size));
+    uint32_t index = VoxelKeyHash(key, map->slot_bits);
+    while (cells[index].hits && (cells[index].key != key)) {
+      index = (index + 1) & mask;
+    }
+
+    VoxelMapCell *cell = &cells[index];
+    if (!cell->hits) {
+      if (map->voxel_count >= map->max_voxels) {
+        map->dropped_points++;
+        continue;
+      }
+      cell->key = key;
+      map->voxel_count++;
+    }
+
+    cell->hits++;
+    cell->intensity += (points[i].reflectivity - cell->intensity) / cell->hits;
+    map->point_count++;
+  }
+}
+
+void VoxelMapSnapshot(const VoxelMap *map, sensor_msgs::PointCloud2 *cloud) {
+  cloud->height = 1;
+  cloud->fields.clear();
+  AddPointField(&cloud->fields, "x", offsetof(VoxelMapPoint, x), sensor_msgs::PointField::FLOAT32);
+  AddPointField(&cloud->fields, "y", offsetof(VoxelMapPoint, y), sensor_msgs::PointField::FLOAT32);
+  AddPointField(&cloud->fields, "z", offsetof(VoxelMapPoint, z), sensor_msgs::PointField::FLOAT32);
+  AddPointField(&cloud->fields, "intensity", offsetof(VoxelMapPoint, intensity), sensor_msgs::PointField::FLOAT32);
+  AddPointField(&cloud->fields, "hits", offsetof(VoxelMapPoint, hits), sensor_msgs::PointField::UINT32);
+  cloud->is_bigendian = false;
+  cloud->point_step = sizeof(VoxelMapPoint);
+  cloud->data.resize(map->voxel_count * sizeof(VoxelMapPoint));
+  cloud->width = map->voxel_count ? VoxelMapCopy(map, (VoxelMapPoint *)&cloud->data[0]) : 0;
+  cloud->row_step = cloud->point_step * cloud->width;
+  cloud->is_dense = true;
+}
+
+int VoxelMapSave(const VoxelMap *map, const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    return -1;
+  }
+
+  std::vector<VoxelMapPoint> points(map->voxel_count);
+  uint32_t count = map->voxel_count ? VoxelMapCopy(map, &points[0]) : 0;
+
+  fprintf(file, "# .PCD v0.7 - Point Cloud Data file format\n"
+                "VERSION 0.7\n"
+                "FIELDS x y z intensity hits\n"
+                "SIZE 4 4 4 4 4\n"
+                "TYPE F F F F U\n"
+                "COUNT 1 1 1 1 1\n"
+                "WIDTH %u\n"
+                "HEIGHT 1\n"
+                "VIEWPOINT 0 0 0 1 0 0 0\n"
+                "POINTS %u\n"
+                "DATA binary\n", count, count);
+  size_t written = count ? fwrite(&points[0], sizeof(VoxelMapPoint), count, file) : 0;
+
+  if ((fclose(file) != 0) || (written != count)) {
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,105 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define __STDC_LIMIT_MACROS
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "livox_driver_core/livox_codec.h"
+
+static LivoxRawPoint MakePoint(int32_t x, int32_t y, int32_t z, uint8_t reflectivity) {
+  LivoxRawPoint point;
+  point.x = x;
+  point.y = y;
+  point.z = z;
+  point.reflectivity = reflectivity;
+  return point;
+}
+
+/* encode, check the size bound, decode and compare point by point */
+static void ExpectRoundTrip(const std::vector<LivoxRawPoint> &points, uint32_t block_points) {
+  uint32_t num = points.size();
+  uint32_t bound = LivoxCodecMaxEncodedSize(num, block_points);
+  std::vector<uint8_t> encoded(bound + 1);
+  uint32_t size = LivoxCodecEncode(num ? &points[0] : NULL, num, block_points, &encoded[0]);
+  ASSERT_LE(size, bound);
+
+  ASSERT_EQ((int32_t)num, LivoxCodecDecodedCount(&encoded[0], size));
+  std::vector<LivoxRawPoint> decoded(num + 1);
+  ASSERT_EQ((int32_t)num, LivoxCodecDecode(&encoded[0], size, &decoded[0], num));
+  for (uint32_t i = 0; i < num; i++) {
+    EXPECT_EQ(0, memcmp(&points[i], &decoded[i], sizeof(LivoxRawPoint))) << "point " << i;
+  }
+}
+
+TEST(LivoxCodec, EmptyInput) {
+  std::vector<LivoxRawPoint> points;
+  ExpectRoundTrip(points, LIVOX_CODEC_BLOCK_POINTS);
+  EXPECT_EQ(0, LivoxCodecDecodedCount(NULL, 0));
+}
+
+TEST(LivoxCodec, SinglePoint) {
+  std::vector<LivoxRawPoint> points(1, MakePoint(1234, -5678, 42, 200));
+  ExpectRoundTrip(points, LIVOX_CODEC_BLOCK_POINTS);
+}
+
+/* small deltas keep the rice parameter low, so the jumps take the escape code */
+TEST(LivoxCodec, EscapeSizedDeltas) {
+  std::vector<LivoxRawPoint> points;
+  for (int32_t i = 0; i < 1000; i++) {
+    int32_t jump = (i % 37 == 0) ? (1 << 30) : 0;
+    points.push_back(MakePoint(10000 + i + jump, -i - jump, (i & 1) ? jump : -jump, (uint8_t)(i * 7)));
+  }
+  ExpectRoundTrip(points, LIVOX_CODEC_BLOCK_POINTS);
+  ExpectRoundTrip(points, LIVOX_CODEC_MAX_BLOCK_POINTS);
+}
+
+TEST(LivoxCodec, Int32Extremes) {
+  std::vector<LivoxRawPoint> points;
+  for (int i = 0; i < 300; i++) {
+    int32_t value = (i & 1) ? INT32_MAX : INT32_MIN;
+    points.push_back(MakePoint(value, -(value + 1), (i % 3) ? 0 : value, (i & 1) ? 255 : 0));
+  }
+  ExpectRoundTrip(points, LIVOX_CODEC_BLOCK_POINTS);
+  ExpectRoundTrip(points, 1);
+}
+
+TEST(LivoxCodec, TruncatedStream) {
+  std::vector<LivoxRawPoint> points;
+  for (int32_t i = 0; i < 250; i++) {
+    points.push_back(MakePoint(i * 3, i * 5, -i, (uint8_t)i));
+  }
+  std::vector<uint8_t> encoded(LivoxCodecMaxEncodedSize(points.size(), LIVOX_CODEC_BLOCK_POINTS));
+  uint32_t size = LivoxCodecEncode(&points[0], points.size(), LIVOX_CODEC_BLOCK_POINTS, &encoded[0]);
+  EXPECT_EQ(-1, LivoxCodecDecodedCount(&encoded[0], size - 1));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,146 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/*
+ * Benchmark of the livox point codec.
+ *
+ * usage: livox_codec_bench [raw_point_file] [block_points]
+ *
+ * raw_point_file holds packed LivoxRawPoint records, e.g. dumped from
+ * GetLidarData. Without it a rosette scan similar to a Mid-40 is generated.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "livox_driver_core/livox_codec.h"
+
+#define SYNTHETIC_POINTS                (1000000)
+#define BENCH_ROUNDS                    (20)
+
+static double NowSec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool LoadPoints(const char *path, std::vector<LivoxRawPoint> *points) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    return false;
+  }
+
+  LivoxRawPoint point;
+  while (fread(&point, sizeof(point), 1, fp) == 1) {
+    points->push_back(point);
+  }
+  fclose(fp);
+
+  return !points->empty();
+}
+
+/* non-repetitive rosette over a 38.4 degree circular FoV, on a wall and a floor */
+static void SynthesizePoints(std::vector<LivoxRawPoint> *points) {
+  const double fov = 38.4 * M_PI / 180.0;
+  srand(1);
+
+  for (uint32_t i = 0; i < SYNTHETIC_POINTS; ++i) {
+    double t = i * 1e-5;
+    double r = 0.5 * fov * sin(2 * M_PI * 17.3 * t);
+    double theta = 2 * M_PI * 3.1 * t;
+    double dy = r * cos(theta);
+    double dz = r * sin(theta);
+
+    double range = 20.0;
+    if (dz < -0.05) {
+      range = std::min(20.0, 1.5 / -dz);
+    }
+    range += 0.02 * ((rand() % 1000) / 1000.0 - 0.5);
+
+    LivoxRawPoint point;
+    point.x = (int32_t)(range * 1000);
+    point.y = (int32_t)(range * dy * 1000);
+    point.z = (int32_t)(range * dz * 1000);
+    point.reflectivity = (uint8_t)(20 + (i / 37) % 60);
+    points->push_back(point);
+  }
+}
+
+int main(int argc, char **argv) {
+  std::vector<LivoxRawPoint> points;
+  uint32_t block_points = LIVOX_CODEC_BLOCK_POINTS;
+
+  if (argc > 1) {
+    if (!LoadPoints(argv[1], &points)) {
+      printf("Can not load points from %s\n", argv[1]);
+      return -1;
+    }
+  } else {
+    SynthesizePoints(&points);
+  }
+  if (argc > 2) {
+    block_points = atoi(argv[2]);
+  }
+
+  uint32_t num = points.size();
+  uint32_t raw_size = num * sizeof(LivoxRawPoint);
+  std::vector<uint8_t> encoded(LivoxCodecMaxEncodedSize(num, block_points));
+  std::vector<LivoxRawPoint> decoded(num);
+
+  uint32_t encoded_size = 0;
+  double start = NowSec();
+  for (int i = 0; i < BENCH_ROUNDS; ++i) {
+    encoded_size = LivoxCodecEncode(&points[0], num, block_points, &encoded[0]);
+  }
+  double encode_sec = (NowSec() - start) / BENCH_ROUNDS;
+
+  int32_t decoded_num = 0;
+  start = NowSec();
+  for (int i = 0; i < BENCH_ROUNDS; ++i) {
+    decoded_num = LivoxCodecDecode(&encoded[0], encoded_size, &decoded[0], num);
+  }
+  double decode_sec = (NowSec() - start) / BENCH_ROUNDS;
+
+  bool lossless = (decoded_num == (int32_t)num) && \
+                  (memcmp(&points[0], &decoded[0], raw_size) == 0);
+
+  printf("points          : %u\n", num);
+  printf("block points    : %u\n", block_points);
+  printf("raw size        : %u bytes\n", raw_size);
+  printf("encoded size    : %u bytes\n", encoded_size);
+  printf("ratio           : %.2f\n", (double)raw_size / encoded_size);
+  printf("bits per point  : %.2f\n", encoded_size * 8.0 / num);
+  printf("encode          : %.1f MB/s per core\n", raw_size / encode_sec / 1e6);
+  printf("decode          : %.1f MB/s per core\n", raw_size / decode_sec / 1e6);
+  printf("lossless        : %s\n", lossless ? "yes" : "NO");
+
+  return lossless ? 0 : -1;
+}
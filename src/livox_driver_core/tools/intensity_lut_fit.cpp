@@ -0,0 +1,180 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/*
+ * Fits an intensity calibration table from points on calibration targets.
+ *
+ * usage: livox_intensity_lut_fit samples_file lut_file [range_bins] [range_step]
+ *
+ * samples_file holds one point per line, "x y z reflectivity reference",
+ * x/y/z in meters and reference the calibrated intensity of the target the
+ * point lies on, e.g. its reflectance in percent. The tool does not read
+ * bags: record a session of targets of a few known reflectances at the
+ * ranges of interest with the xyzi layout and no intensity_lut_dir, so the
+ * intensity is the raw reflectivity, export the frames (e.g. pcl_ros
+ * bag_to_pcd), crop the points of each target and append its reference. Per
+ * range bin, the median raw reflectivity of every target is mapped to its
+ * reference and the table interpolates linearly in between, from 0 at raw 0.
+ * Save the table as <broadcast code>.lut in intensity_lut_dir.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "livox_driver_core/intensity_lut.h"
+
+#define RANGE_STEP_DEFAULT              (10.0)    // m
+#define MIN_TARGET_SAMPLES              (20)      // points of a target in a bin to use it
+
+typedef std::map<double, std::vector<uint8_t> > TargetSamples;   // reference -> raw reflectivities
+
+/* median raw reflectivity and reference of the targets of one bin, raw ascending */
+static std::vector<std::pair<double, double> > ControlPoints(TargetSamples &targets) {
+  std::vector<std::pair<double, double> > points;
+  for (TargetSamples::iterator it = targets.begin(); it != targets.end(); ++it) {
+    std::vector<uint8_t> &raw = it->second;
+    if (raw.size() < MIN_TARGET_SAMPLES) {
+      continue;
+    }
+    std::nth_element(raw.begin(), raw.begin() + raw.size() / 2, raw.end());
+    points.push_back(std::make_pair((double)raw[raw.size() / 2], it->first));
+  }
+  std::sort(points.begin(), points.end());
+  return points;
+}
+
+/* piecewise linear through (0, 0) and the control points, the last segment extends to 255 */
+static void FitTable(const std::vector<std::pair<double, double> > &control, float *table) {
+  std::vector<std::pair<double, double> > knots(1, std::make_pair(0.0, 0.0));
+  for (size_t i = 0; i < control.size(); i++) {
+    /* keep the table monotonic, targets swapped by noise are dropped */
+    if ((control[i].first > knots.back().first) && (control[i].second >= knots.back().second)) {
+      knots.push_back(control[i]);
+    }
+  }
+
+  size_t segment = 1;
+  for (int raw = 0; raw < INTENSITY_LUT_SIZE; raw++) {
+    while ((segment + 1 < knots.size()) && (raw > knots[segment].first)) {
+      segment++;
+    }
+    if (knots.size() < 2) {
+      table[raw] = raw;
+      continue;
+    }
+    const std::pair<double, double> &a = knots[segment - 1];
+    const std::pair<double, double> &b = knots[segment];
+    double value = a.second + (raw - a.first) * (b.second - a.second) / (b.first - a.first);
+    table[raw] = (float)((value < 0.0) ? 0.0 : value);
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    printf("usage: %s samples_file lut_file [range_bins] [range_step]\n", argv[0]);
+    return -1;
+  }
+
+  IntensityLut lut;
+  lut.range_bins = (argc > 3) ? atoi(argv[3]) : 1;
+  lut.range_step = (argc > 4) ? atof(argv[4]) : RANGE_STEP_DEFAULT;
+  if ((lut.range_bins < 1) || (lut.range_bins > INTENSITY_LUT_RANGE_BINS) || (lut.range_step <= 0)) {
+    printf("range_bins must be 1~%d and range_step positive\n", INTENSITY_LUT_RANGE_BINS);
+    return -1;
+  }
+
+  FILE *fp = fopen(argv[1], "r");
+  if (!fp) {
+    printf("open %s failed\n", argv[1]);
+    return -1;
+  }
+
+  std::vector<TargetSamples> bins(lut.range_bins);
+  char line[256];
+  uint32_t count = 0;
+  while (fgets(line, sizeof(line), fp)) {
+    double x, y, z, reference;
+    int reflectivity;
+    if ((line[0] == '#') || (sscanf(line, "%lf %lf %lf %d %lf", &x, &y, &z, &reflectivity, &reference) != 5) ||
+        (reflectivity < 0) || (reflectivity > 255)) {
+      continue;
+    }
+
+    /* the sample belongs to the bin whose center is nearest */
+    double range = sqrt(x * x + y * y + z * z);
+    uint32_t bin = (uint32_t)(range / lut.range_step);
+    bin = (bin < lut.range_bins) ? bin : lut.range_bins - 1;
+    bins[bin][reference].push_back((uint8_t)reflectivity);
+    count++;
+  }
+  fclose(fp);
+  printf("%u samples\n", count);
+
+  std::vector<bool> fitted(lut.range_bins, false);
+  for (uint32_t bin = 0; bin < lut.range_bins; bin++) {
+    std::vector<std::pair<double, double> > control = ControlPoints(bins[bin]);
+    printf("bin %u (%.1f~%.1fm):", bin, bin * lut.range_step, (bin + 1) * lut.range_step);
+    for (size_t i = 0; i < control.size(); i++) {
+      printf(" raw %.0f -> %.2f", control[i].first, control[i].second);
+    }
+    printf("\n");
+
+    if (!control.empty()) {
+      FitTable(control, lut.table[bin]);
+      fitted[bin] = true;
+    }
+  }
+
+  /* bins without targets take the table of the nearest fitted bin */
+  for (uint32_t bin = 0; bin < lut.range_bins; bin++) {
+    if (fitted[bin]) {
+      continue;
+    }
+    int nearest = -1;
+    for (int other = 0; other < (int)lut.range_bins; other++) {
+      if (fitted[other] && ((nearest < 0) || (abs(other - (int)bin) < abs(nearest - (int)bin)))) {
+        nearest = other;
+      }
+    }
+    if (nearest < 0) {
+      printf("no target with %d samples in any bin\n", MIN_TARGET_SAMPLES);
+      return -1;
+    }
+    printf("bin %u has no targets, use bin %d\n", bin, nearest);
+    std::copy(lut.table[nearest], lut.table[nearest] + INTENSITY_LUT_SIZE, lut.table[bin]);
+  }
+
+  if (IntensityLutSave(&lut, argv[2])) {
+    printf("write %s failed\n", argv[2]);
+    return -1;
+  }
+  printf("wrote %s\n", argv[2]);
+  return 0;
+}